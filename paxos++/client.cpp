@@ -77,6 +77,21 @@ client::send (
    return promise->get_future ();
 }
 
+std::vector <connection_statistics>
+client::statistics ()
+{
+   std::promise <std::vector <connection_statistics> > promise;
+   std::future <std::vector <connection_statistics> > future = promise.get_future ();
+
+   io_service_.post (
+      [this, & promise] ()
+      {
+         promise.set_value (quorum_.connection_statistics ());
+      });
+
+   return future.get ();
+}
+
 void
 client::do_request (
    boost::shared_ptr <std::promise <std::string> >      promise,
@@ -183,6 +198,18 @@ client::do_request (
                                  std::make_exception_ptr (
                                     exception::no_majority ()));
                               break;
+
+                           case detail::error_protocol_mismatch:
+                              promise->set_exception (
+                                 std::make_exception_ptr (
+                                    exception::protocol_mismatch ()));
+                              break;
+
+                           case detail::error_storage:
+                              promise->set_exception (
+                                 std::make_exception_ptr (
+                                    exception::storage_error ()));
+                              break;
                               
                            default:
                               PAXOS_UNREACHABLE ();
@@ -14,6 +14,7 @@
 #include "detail/client/protocol/request.hpp"
 
 #include "configuration.hpp"
+#include "connection_statistics.hpp"
 
 namespace paxos {
 
@@ -157,6 +158,16 @@ public:
       uint16_t                  retries = 10) 
       throw ();
 
+   /*!
+     \brief Statistics of the connections to the servers in the quorum
+
+     Useful to find out whether a server cannot keep up with our requests. The
+     statistics are collected by the io_service, and this function blocks until that has
+     happened: it must never be called from a handler that runs on that io_service.
+    */
+   std::vector <connection_statistics>
+   statistics ();
+
 private:
 
    void
@@ -10,6 +10,11 @@ namespace paxos {
 configuration::configuration ()
    : timeout_ (3000),
      majority_factor_ (0.5),
+     commit_on_majority_ (false),
+     max_inflight_proposals_ (1),
+     batch_max_entries_ (1),
+     batch_max_bytes_ (1024 * 1024),
+     batch_linger_ (0),
      durable_storage_ (new durable::heap ()),
      strategy_factory_ (new detail::strategy::basic_paxos::factory (*this))
 {
@@ -41,6 +46,87 @@ configuration::majority_factor () const
    return majority_factor_;
 }
 
+void
+configuration::set_commit_on_majority (
+   bool         enabled)
+{
+   commit_on_majority_ = enabled;
+}
+
+bool
+configuration::commit_on_majority () const
+{
+   return commit_on_majority_;
+}
+
+void
+configuration::set_divergence_callback (
+   divergence_callback_type const &     callback)
+{
+   divergence_callback_ = callback;
+}
+
+configuration::divergence_callback_type const &
+configuration::divergence_callback () const
+{
+   return divergence_callback_;
+}
+
+void
+configuration::set_max_inflight_proposals (
+   size_t       proposals)
+{
+   PAXOS_ASSERT (proposals > 0);
+   max_inflight_proposals_ = proposals;
+}
+
+size_t
+configuration::max_inflight_proposals () const
+{
+   return max_inflight_proposals_;
+}
+
+void
+configuration::set_batch_max_entries (
+   size_t       entries)
+{
+   PAXOS_ASSERT (entries > 0);
+   batch_max_entries_ = entries;
+}
+
+size_t
+configuration::batch_max_entries () const
+{
+   return batch_max_entries_;
+}
+
+void
+configuration::set_batch_max_bytes (
+   size_t       bytes)
+{
+   PAXOS_ASSERT (bytes > 0);
+   batch_max_bytes_ = bytes;
+}
+
+size_t
+configuration::batch_max_bytes () const
+{
+   return batch_max_bytes_;
+}
+
+void
+configuration::set_batch_linger (
+   uint32_t     linger)
+{
+   batch_linger_ = linger;
+}
+
+uint32_t
+configuration::batch_linger () const
+{
+   return batch_linger_;
+}
+
 void
 configuration::set_strategy_factory (
    detail::strategy::factory *  factory)
@@ -6,9 +6,14 @@
 #define LIBPAXOS_CPP_CONFIGURATION_HPP
 
 #include <stdint.h>
+#include <stddef.h>
 
+#include <string>
+
+#include <boost/function.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/asio/ip/tcp.hpp>
 
 namespace paxos { namespace durable {
 class storage;
@@ -25,6 +30,19 @@ namespace paxos {
  */
 class configuration : private boost::noncopyable
 {
+public:
+
+   /*!
+     \brief Called by the leader when a server replied differently than the response the clients received
+     \param proposal_id         The proposal the response belongs to
+     \param server              The server that replied differently
+     \param response            The response the client received
+     \param divergent_response  The response of \c server
+    */
+   typedef boost::function <void (int64_t                               proposal_id,
+                                  boost::asio::ip::tcp::endpoint const & server,
+                                  std::string const &                    response,
+                                  std::string const &                    divergent_response)>  divergence_callback_type;
 
 public:
 
@@ -65,6 +83,122 @@ public:
    double
    majority_factor () const;
 
+   /*!
+     \brief Controls whether a leader replies to clients as soon as a majority has accepted a proposal
+
+     By default, a leader waits for every live server to accept a proposal before it replies to
+     the clients, which means a single slow server determines the latency of every request.
+     When enabled, the leader replies as soon as the servers that accepted the proposal form a
+     majority according to majority_factor (). The remaining servers still process the proposal
+     in the background; if any of them replies differently, the divergence callback is called
+     instead of failing the request.
+
+     Defaults to false
+    */
+   void
+   set_commit_on_majority (
+      bool      enabled);
+
+   /*!
+     \brief Access to whether a leader replies as soon as a majority has accepted a proposal
+    */
+   bool
+   commit_on_majority () const;
+
+   /*!
+     \brief Adjusts the callback that reports servers that processed a committed proposal differently
+
+     This is only called when commit_on_majority () is enabled, since otherwise a divergent
+     response fails the request with paxos::exception::inconsistent_response.
+    */
+   void
+   set_divergence_callback (
+      divergence_callback_type const &  callback);
+
+   /*!
+     \brief Access to the callback that reports servers that processed a proposal differently
+    */
+   divergence_callback_type const &
+   divergence_callback () const;
+
+   /*!
+     \brief Adjusts the amount of proposals a leader can have in progress at the same time
+     \pre proposals > 0
+
+     When this is larger than 1, the leader does not wait for a proposal to be accepted by all
+     followers before it sends out the next one. The followers still process the proposals in
+     order, and every client still receives the result of its own proposal.
+
+     Defaults to 1
+    */
+   void
+   set_max_inflight_proposals (
+      size_t    proposals);
+
+   /*!
+     \brief Access to the amount of proposals a leader can have in progress at the same time
+    */
+   size_t
+   max_inflight_proposals () const;
+
+   /*!
+     \brief Adjusts the maximum amount of client requests a leader combines in a single proposal
+     \pre entries > 0
+
+     When multiple client requests are waiting to be processed, the leader proposes them
+     together in a single 'accept' round. Every request is still applied separately by the
+     processor, and every client still receives the result of its own request.
+
+     Defaults to 1, which disables batching
+    */
+   void
+   set_batch_max_entries (
+      size_t    entries);
+
+   /*!
+     \brief Access to the maximum amount of client requests combined in a single proposal
+    */
+   size_t
+   batch_max_entries () const;
+
+   /*!
+     \brief Adjusts the maximum combined size of the workloads of a single proposal, in bytes
+     \pre bytes > 0
+
+     A request that is larger than this on its own is still proposed, but is never combined
+     with other requests.
+
+     Defaults to 1 megabyte
+    */
+   void
+   set_batch_max_bytes (
+      size_t    bytes);
+
+   /*!
+     \brief Access to the maximum combined size of the workloads of a single proposal
+    */
+   size_t
+   batch_max_bytes () const;
+
+   /*!
+     \brief Adjusts the time a leader waits for more client requests before it proposes a batch
+     \param linger Linger time in microseconds
+
+     This trades latency for throughput when requests arrive too slowly to queue up behind
+     each other. It only has effect when batch_max_entries () is larger than 1.
+
+     Defaults to 0
+    */
+   void
+   set_batch_linger (
+      uint32_t  linger);
+
+   /*!
+     \brief Access to the time a leader waits for more client requests, in microseconds
+    */
+   uint32_t
+   batch_linger () const;
+
    /*!
      \brief Adjusts the strategy used for internal paxos protocol
      \note Takes over ownership of \c factory
@@ -97,6 +231,12 @@ private:
 
    uint32_t                                             timeout_;
    double                                               majority_factor_;
+   bool                                                 commit_on_majority_;
+   divergence_callback_type                             divergence_callback_;
+   size_t                                               max_inflight_proposals_;
+   size_t                                               batch_max_entries_;
+   size_t                                               batch_max_bytes_;
+   uint32_t                                             batch_linger_;
 
    boost::shared_ptr <durable::storage>                 durable_storage_;
    boost::shared_ptr <detail::strategy::factory>        strategy_factory_;
@@ -0,0 +1,47 @@
+/*!
+  Copyright (c) 2012, Leon Mergen, all rights reserved.
+ */
+
+#ifndef LIBPAXOS_CPP_CONNECTION_STATISTICS_HPP
+#define LIBPAXOS_CPP_CONNECTION_STATISTICS_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <string>
+
+namespace paxos {
+
+/*!
+  \brief Statistics of the connection to a single server in the quorum
+
+  A queue that keeps growing means that the server cannot keep up with the data we send it.
+ */
+struct connection_statistics
+{
+   /*!
+     \brief Address of the server
+    */
+   std::string  host;
+
+   /*!
+     \brief Port of the server
+    */
+   uint16_t     port;
+
+   /*!
+     \brief Amount of bytes that are waiting to be written to the server, including the data
+            that is currently being written
+    */
+   size_t       queued_bytes;
+
+   /*!
+     \brief Highest amount of bytes that have been waiting to be written to the server at the
+            same time
+    */
+   size_t       max_queued_bytes;
+};
+
+}
+
+#endif  //! LIBPAXOS_CPP_CONNECTION_STATISTICS_HPP
@@ -1,38 +1,172 @@
-#include <sstream>
-
-#include <boost/uuid/uuid_io.hpp>
-#include <boost/uuid/string_generator.hpp>
-
-#include <boost/archive/text_oarchive.hpp>
-#include <boost/archive/text_iarchive.hpp>
-
+#include "util/binary_writer.hpp"
+#include "util/binary_reader.hpp"
 #include "util/debug.hpp"
 #include "command.hpp"
 
 namespace paxos { namespace detail { 
 
 
+/*! static */ uint8_t const command::wire_version;
+
+
 /*! static */ std::string
 command::to_string (
    command const &      command)
 {
-   std::stringstream               value;
-   boost::archive::text_oarchive oa (value);
-   oa << command;
+   std::string                  buffer;
+   util::binary_writer          writer (buffer);
+
+   /*!
+     Reserve enough room for everything except the workloads up front, which is the only
+     variable-sized part of a command that can become big.
+    */
+   size_t workload_size = command.workload_.size ();
+   for (auto const & i : command.proposed_workload_)
+   {
+      workload_size += i.second.size () + 16;
+   }
+
+   buffer.reserve (64 + workload_size);
+
+   writer.write_byte (wire_version);
+
+   writer.write_varint (command.type_);
+   writer.write_varint (command.error_code_);
+
+   writer.write_bytes (command.host_id_.data, command.host_id_.size ());
 
-   return value.str ();
+   if (command.host_endpoint_.address ().is_v6 () == true)
+   {
+      boost::asio::ip::address_v6::bytes_type bytes = command.host_endpoint_.address ().to_v6 ().to_bytes ();
+
+      writer.write_byte (6);
+      writer.write_bytes (bytes.data (), bytes.size ());
+   }
+   else
+   {
+      boost::asio::ip::address_v4::bytes_type bytes = command.host_endpoint_.address ().to_v4 ().to_bytes ();
+
+      writer.write_byte (4);
+      writer.write_bytes (bytes.data (), bytes.size ());
+   }
+
+   writer.write_uint16 (command.host_endpoint_.port ());
+
+   writer.write_signed_varint (command.next_proposal_id_);
+   writer.write_signed_varint (command.highest_proposal_id_);
+   writer.write_signed_varint (command.lowest_proposal_id_);
+
+   writer.write_string (command.workload_);
+
+   writer.write_varint (command.proposed_workload_.size ());
+   for (auto const & i : command.proposed_workload_)
+   {
+      writer.write_signed_varint (i.first);
+      writer.write_string (i.second);
+   }
+
+   return buffer;
 }
 
 
-/*! static */ command
+/*! static */ boost::optional <command>
 command::from_string (
-   std::string const &  string)
+   char const *         data,
+   size_t               size)
 {
-   command ret;
-
-   std::stringstream value (string);
-   boost::archive::text_iarchive ia (value);
-   ia >> ret;
+   util::binary_reader  reader (data, size);
+   command              ret;
+
+   uint8_t              version;
+   uint64_t             type;
+   uint64_t             error_code;
+   uint8_t              address_family;
+   uint16_t             port;
+   uint64_t             proposed_workload_size;
+
+   if (reader.read_byte (version) == false)
+   {
+      return boost::none;
+   }
+
+   if (version != wire_version)
+   {
+      PAXOS_WARN ("received command with wire format version " << static_cast <int> (version) << ", expected version " << static_cast <int> (wire_version));
+      return boost::none;
+   }
+
+   if (reader.read_varint (type) == false
+       || type > type_request_error
+       || reader.read_varint (error_code) == false
+       || error_code > error_storage
+       || reader.read_bytes (ret.host_id_.data, ret.host_id_.size ()) == false
+       || reader.read_byte (address_family) == false)
+   {
+      return boost::none;
+   }
+
+   ret.type_       = static_cast <enum type> (type);
+   ret.error_code_ = static_cast <enum detail::error_code> (error_code);
+
+   boost::asio::ip::address address;
+
+   if (address_family == 6)
+   {
+      boost::asio::ip::address_v6::bytes_type bytes;
+
+      if (reader.read_bytes (bytes.data (), bytes.size ()) == false)
+      {
+         return boost::none;
+      }
+
+      address = boost::asio::ip::address_v6 (bytes);
+   }
+   else if (address_family == 4)
+   {
+      boost::asio::ip::address_v4::bytes_type bytes;
+
+      if (reader.read_bytes (bytes.data (), bytes.size ()) == false)
+      {
+         return boost::none;
+      }
+
+      address = boost::asio::ip::address_v4 (bytes);
+   }
+   else
+   {
+      return boost::none;
+   }
+
+   if (reader.read_uint16 (port) == false
+       || reader.read_signed_varint (ret.next_proposal_id_) == false
+       || reader.read_signed_varint (ret.highest_proposal_id_) == false
+       || reader.read_signed_varint (ret.lowest_proposal_id_) == false
+       || reader.read_string (ret.workload_) == false
+       || reader.read_varint (proposed_workload_size) == false)
+   {
+      return boost::none;
+   }
+
+   ret.host_endpoint_ = boost::asio::ip::tcp::endpoint (address, port);
+
+   for (uint64_t i = 0; i < proposed_workload_size; ++i)
+   {
+      int64_t           proposal_id;
+      std::string       workload;
+
+      if (reader.read_signed_varint (proposal_id) == false
+          || reader.read_string (workload) == false)
+      {
+         return boost::none;
+      }
+
+      ret.proposed_workload_[proposal_id].swap (workload);
+   }
+
+   if (reader.at_end () == false)
+   {
+      return boost::none;
+   }
 
    return ret;
 }
@@ -42,33 +176,27 @@ void
 command::set_host_id (
    boost::uuids::uuid const &        id)
 {
-   std::stringstream str;
-   str << id;
-
-   host_id_ = str.str ();
+   host_id_ = id;
 }
 
 boost::uuids::uuid
 command::host_id () const
 {
-   boost::uuids::string_generator gen;
-   return gen (host_id_);
+   return host_id_;
 }
 
 void
 command::set_host_endpoint (
    boost::asio::ip::tcp::endpoint const &       endpoint)
 {
-   host_address_ = endpoint.address ().to_string ();
-   host_port_    = endpoint.port ();
+   host_endpoint_ = endpoint;
 }
 
 
 boost::asio::ip::tcp::endpoint
 command::host_endpoint () const
 {
-   return boost::asio::ip::tcp::endpoint (boost::asio::ip::address::from_string (host_address_), 
-                                          host_port_);
+   return host_endpoint_;
 }
 
 void
@@ -5,14 +5,15 @@
 #ifndef LIBPAXOS_CPP_DETAIL_PROTOCOL_COMMAND_HPP
 #define LIBPAXOS_CPP_DETAIL_PROTOCOL_COMMAND_HPP
 
+#include <map>
+
 #include <boost/function.hpp>
+#include <boost/optional.hpp>
 #include <boost/uuid/uuid.hpp>
+#include <boost/uuid/nil_generator.hpp>
 #include <boost/asio/ip/address.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
-#include <boost/serialization/access.hpp>
-#include <boost/serialization/map.hpp>
-
 #include "quorum/server.hpp"
 
 #include "error.hpp"
@@ -21,12 +22,19 @@ namespace paxos { namespace detail {
 
 /*!
   \brief Describes command that is exchanged between servers
+
+  Commands are exchanged in a compact binary format, which starts with a version byte. This
+  allows us to detect hosts that speak a different version of the protocol, rather than
+  misinterpreting their data.
  */
 class command
 {
 public:
 
-   friend class boost::serialization::access;
+   /*!
+     \brief Version of the wire format produced by to_string ()
+    */
+   static uint8_t const wire_version = 1;
 
    enum type
    {
@@ -64,9 +72,15 @@ public:
     */
    command ();
 
-   static command
+   /*!
+     \brief Decodes a command directly from a network buffer
+     \returns Returns the command, or nothing if the data is malformed or was encoded using
+              a different wire format version
+    */
+   static boost::optional <command>
    from_string (
-      std::string const &               string);
+      char const *                      data,
+      size_t                            size);
 
    static std::string
    to_string (
@@ -174,21 +188,13 @@ public:
    std::map <int64_t, std::string> const &
    proposed_workload () const;
 
-private:
-
-   template <class Archive>
-   void serialize (
-      Archive &                 ar,
-      unsigned int const        version);
-   
 private:
 
    enum type                                            type_;
    enum detail::error_code                              error_code_;
 
-   std::string                                          host_id_;
-   std::string                                          host_address_;
-   uint16_t                                             host_port_;
+   boost::uuids::uuid                                   host_id_;
+   boost::asio::ip::tcp::endpoint                       host_endpoint_;
 
    int64_t                                              next_proposal_id_;
    int64_t                                              highest_proposal_id_;
@@ -4,6 +4,7 @@ namespace paxos { namespace detail {
 inline command::command ()
    : type_ (type_invalid),
      error_code_ (no_error),
+     host_id_ (boost::uuids::nil_uuid ()),
      next_proposal_id_ (-1),
      highest_proposal_id_ (-1),
      lowest_proposal_id_ (-1)
@@ -105,26 +106,4 @@ command::proposed_workload () const
 }
 
 
-template <class Archive>
-inline void
-command::serialize (
-   Archive &                 ar,
-   unsigned int const        version) 
-{
-   ar & type_;
-   ar & error_code_;
-
-   ar & host_id_;
-   ar & host_address_;
-   ar & host_port_;
-
-   ar & next_proposal_id_;
-   ar & highest_proposal_id_;
-   ar & lowest_proposal_id_;
-
-   ar & workload_;
-   ar & proposed_workload_;
-}
-
-
 }; };
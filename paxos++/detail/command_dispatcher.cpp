@@ -28,8 +28,7 @@ command_dispatcher::dispatch_command (
          case command::type_request_initiate:
             state.request_queue ().push (
                {
-                  connection,
-                  command,
+                  { { connection, command } },
                   quorum,
                   state
                });
@@ -32,6 +32,14 @@ to_string (
          case error_no_majority:
             return "No majority";
             break;
+
+         case error_protocol_mismatch:
+            return "Protocol mismatch";
+            break;
+
+         case error_storage:
+            return "Storage error";
+            break;
    };
 
    PAXOS_UNREACHABLE ();
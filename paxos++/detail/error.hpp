@@ -44,7 +44,18 @@ enum error_code
      This error is sent back when there is no majority of servers arelive; for more information
      on why this error is sent, see the description of paxos::exception::no_majority
     */
-   error_no_majority
+   error_no_majority,
+
+   /*!
+     This error is sent back when a host sent us data we could not decode; this usually means
+     it speaks a different version of the wire protocol.
+    */
+   error_protocol_mismatch,
+
+   /*!
+     This error is sent back when a host was unable to write a proposal to its durable storage.
+    */
+   error_storage
 };
 
 
@@ -5,7 +5,7 @@
 #ifndef LIBPAXOS_CPP_DETAIL_PARSER_HPP
 #define LIBPAXOS_CPP_DETAIL_PARSER_HPP
 
-#include <boost/shared_array.hpp>
+#include <stddef.h>
 
 #include "error.hpp"
 #include "tcp_connection_fwd.hpp"
@@ -14,14 +14,15 @@
 namespace paxos { namespace detail {
 
 /*!
-  \brief Interface for reading commands from tcp stream and dispatching to the correct handler
+  \brief Interface for writing commands to and decoding commands from a tcp stream
+
+  Every command is sent as a frame, which consists of a 4 byte size followed by the encoded
+  command.
  */
 class parser
 {
 public:
 
-   typedef boost::function <void (boost::optional <enum error_code>, command const &)>  callback_function;
-
    /*!
      \brief Writes command to connection
      \param connection  Connection to write command to
@@ -34,35 +35,27 @@ public:
 
 
    /*!
-     \brief Reads single command from input stream and dispatches to callback function 
-     \param connection  Connection to read from
-     \param callback    Callback function object
+     \brief Returns the size of the frame at the front of a buffer
+     \param data        Received data
+     \param size        Amount of bytes in data
+     \returns Returns the size of the frame including its header, or nothing if the buffer
+              does not contain a complete header yet
     */
-   static void
-   read_command (
-      tcp_connection_ptr        connection,
-      callback_function         callback);
-
-
-private:
-
-   static void
-   read_command_parse_size (
-      tcp_connection_ptr                connection,
-      boost::system::error_code const & error,
-      size_t                            bytes_transferred,
-      boost::shared_array <char>        buffer,
-      callback_function                 callback);
-
-   static void
-   read_command_parse_command (
-      tcp_connection_ptr                connection,
-      boost::system::error_code const & error,
-      size_t                            bytes_transferred,
-      boost::shared_array <char>        buffer,
-      callback_function                 callback);
-
+   static boost::optional <size_t>
+   frame_size (
+      char const *              data,
+      size_t                    size);
 
+   /*!
+     \brief Decodes the command of a complete frame
+     \param data        Start of the frame
+     \param size        Size of the frame, as returned by frame_size ()
+     \returns Returns the command, or nothing if the frame could not be decoded
+    */
+   static boost::optional <command>
+   parse_command (
+      char const *              data,
+      size_t                    size);
 };
 
 }; };
@@ -1,3 +1,6 @@
+#include <boost/bind.hpp>
+#include <boost/asio/deadline_timer.hpp>
+
 #include "strategy/factory.hpp"
 #include "strategy/strategy.hpp"
 
@@ -9,21 +12,21 @@ namespace paxos { namespace detail {
 
 
 paxos_context::paxos_context (
+   boost::asio::io_service &            io_service,
    processor_type const &               processor,
    paxos::configuration &               configuration)
-   : processor_ (processor),
+   : io_service_ (io_service),
+     batch_max_entries_ (configuration.batch_max_entries ()),
+     batch_max_bytes_ (configuration.batch_max_bytes ()),
+     batch_linger_ (configuration.batch_linger ()),
+     commit_on_majority_ (configuration.commit_on_majority ()),
+     divergence_callback_ (configuration.divergence_callback ()),
+     processor_ (processor),
      strategy_ (configuration.strategy_factory ().create ()),
      request_queue_ (
-        []
-        (strategy::request const &                                                      request,
-         detail::request_queue::queue <detail::strategy::request>::guard::pointer       guard)
-        {
-           request.global_state_.strategy ().initiate (request.connection_,
-                                                       request.command_,
-                                                       request.quorum_,
-                                                       request.global_state_,
-                                                       guard);
-        })
+        boost::bind (&paxos_context::process_request, this, _1, _2),
+        configuration.max_inflight_proposals (),
+        boost::bind (&paxos_context::merge_requests, this, _1, _2))
 {
 }
 
@@ -33,4 +36,77 @@ paxos_context::~paxos_context ()
 }
 
 
+void
+paxos_context::process_request (
+   strategy::request const &                                    request,
+   request_queue::queue <strategy::request>::guard::pointer     guard)
+{
+   if (batch_linger_ == 0
+       || request.clients_.size () >= batch_max_entries_)
+   {
+      strategy ().initiate (request.clients_,
+                            request.quorum_,
+                            request.global_state_,
+                            guard);
+      return;
+   }
+
+   /*!
+     Our batch is not full yet, so give other clients a chance to add their requests to it.
+     Since we are holding on to the queue guard, new requests will wait in line behind us,
+     and we can merge them into our own request when our timer expires.
+    */
+   boost::shared_ptr <boost::asio::deadline_timer> timer (
+      new boost::asio::deadline_timer (io_service_));
+
+   timer->expires_from_now (boost::posix_time::microseconds (batch_linger_));
+   timer->async_wait (
+      [this, timer, request, guard]
+      (boost::system::error_code const &)
+      {
+         strategy::request batch (request);
+         request_queue_.merge_waiting (batch);
+
+         strategy ().initiate (batch.clients_,
+                               batch.quorum_,
+                               batch.global_state_,
+                               guard);
+      });
+}
+
+
+bool
+paxos_context::merge_requests (
+   strategy::request &                                          batch,
+   strategy::request const &                                    next) const
+{
+   if (batch.clients_.size () + next.clients_.size () > batch_max_entries_)
+   {
+      return false;
+   }
+
+   size_t bytes = 0;
+
+   for (strategy::client_request const & client : batch.clients_)
+   {
+      bytes += client.command_.workload ().size ();
+   }
+
+   for (strategy::client_request const & client : next.clients_)
+   {
+      bytes += client.command_.workload ().size ();
+   }
+
+   if (bytes > batch_max_bytes_)
+   {
+      return false;
+   }
+
+   batch.clients_.insert (batch.clients_.end (),
+                          next.clients_.begin (),
+                          next.clients_.end ());
+   return true;
+}
+
+
 }; };
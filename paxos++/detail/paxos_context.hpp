@@ -9,14 +9,13 @@
 #include <string>
 
 #include <boost/function.hpp>
+#include <boost/asio/io_service.hpp>
+
+#include "../configuration.hpp"
 
 #include "strategy/request.hpp"
 #include "request_queue/queue.hpp"
 
-namespace paxos { 
-class configuration;
-};
-
 namespace paxos { namespace detail { namespace strategy {
 class strategy;
 }; }; };
@@ -36,6 +35,7 @@ public:
 public:
 
    paxos_context (
+      boost::asio::io_service & io_service,
       processor_type const &    processor,
       paxos::configuration &    configuration);
 
@@ -47,11 +47,24 @@ public:
    detail::strategy::strategy &
    strategy ();
 
+   /*!
+     \brief Whether the leader replies to clients as soon as a majority has accepted a proposal
+    */
+   bool
+   commit_on_majority () const;
+
+   /*!
+     \brief Reports servers that processed a committed proposal differently than the majority
+    */
+   paxos::configuration::divergence_callback_type const &
+   divergence_callback () const;
+
    /*!
      \brief This is our request queue where pending Paxos requests are queued
 
-     Since our paxos protocol only allows one proposal at the same time, this queue ensures
-     that this guarantee is provided.
+     This queue ensures that no more than configuration::max_inflight_proposals () proposals
+     are in progress at the same time, and combines waiting requests into a single proposal
+     according to configuration::batch_max_entries () and configuration::batch_max_bytes ().
     */
 
    request_queue::queue <strategy::request> &
@@ -59,6 +72,34 @@ public:
 
 private:
 
+   /*!
+     \brief Called by the request queue when a request can be processed
+
+     Waits for configuration::batch_linger () microseconds for more requests to arrive if
+     the request can still be combined with other requests.
+    */
+   void
+   process_request (
+      strategy::request const &                                         request,
+      request_queue::queue <strategy::request>::guard::pointer          guard);
+
+   /*!
+     \brief Combines the clients of \c next into \c batch, if the batch limits allow it
+    */
+   bool
+   merge_requests (
+      strategy::request &                                               batch,
+      strategy::request const &                                         next) const;
+
+private:
+
+   boost::asio::io_service &                    io_service_;
+   size_t                                       batch_max_entries_;
+   size_t                                       batch_max_bytes_;
+   uint32_t                                     batch_linger_;
+   bool                                         commit_on_majority_;
+   paxos::configuration::divergence_callback_type divergence_callback_;
+
    processor_type                               processor_;
    detail::strategy::strategy *                 strategy_;
    request_queue::queue <strategy::request>     request_queue_;
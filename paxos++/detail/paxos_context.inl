@@ -12,6 +12,18 @@ paxos_context::strategy ()
    return *strategy_;
 }
 
+inline bool
+paxos_context::commit_on_majority () const
+{
+   return commit_on_majority_;
+}
+
+inline paxos::configuration::divergence_callback_type const &
+paxos_context::divergence_callback () const
+{
+   return divergence_callback_;
+}
+
 
 inline request_queue::queue <strategy::request> &
 paxos_context::request_queue ()
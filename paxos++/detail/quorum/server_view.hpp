@@ -48,6 +48,13 @@ public:
    bool
    has_majority ();
 
+   /*!
+     \brief Determines whether \c count servers form a majority of the quorum
+    */
+   bool
+   is_majority (
+      size_t    count) const;
+
    /*!
      \brief Returns endpoint of server that should be leader
     */
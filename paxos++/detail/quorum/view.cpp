@@ -2,6 +2,7 @@
 #include <boost/uuid/uuid_io.hpp>
 
 #include "../util/debug.hpp"
+#include "../tcp_connection.hpp"
 #include "view.hpp"
 
 namespace paxos { namespace detail { namespace quorum {
@@ -106,4 +107,28 @@ view::lowest_proposal_id () const
    return lowest_proposal_id;
 }
 
+std::vector <paxos::connection_statistics>
+view::connection_statistics ()
+{
+   std::vector <paxos::connection_statistics> result;
+
+   for (auto & i : servers_)
+   {
+      if (i.second.has_connection () == false)
+      {
+         continue;
+      }
+
+      paxos::connection_statistics statistics;
+      statistics.host             = i.first.address ().to_string ();
+      statistics.port             = i.first.port ();
+      statistics.queued_bytes     = i.second.connection ()->queued_bytes ();
+      statistics.max_queued_bytes = i.second.connection ()->max_queued_bytes ();
+
+      result.push_back (statistics);
+   }
+
+   return result;
+}
+
 }; }; };
@@ -13,6 +13,7 @@
 #include <boost/asio/ip/tcp.hpp>
 
 #include "../../configuration.hpp"
+#include "../../connection_statistics.hpp"
 #include "server.hpp"
 
 namespace paxos { namespace detail { namespace quorum {
@@ -80,6 +81,12 @@ public:
    int64_t
    lowest_proposal_id () const;
 
+   /*!
+     \brief Returns the statistics of the connections to all servers we are connected to
+    */
+   std::vector <paxos::connection_statistics>
+   connection_statistics ();
+
 protected:
 
    std::map <boost::asio::ip::tcp::endpoint, detail::quorum::server>    servers_;
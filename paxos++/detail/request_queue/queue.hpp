@@ -5,6 +5,7 @@
 #ifndef LIBPAXOS_CPP_DETAIL_PAXOS_REQUEST_QUEUE_HPP
 #define LIBPAXOS_CPP_DETAIL_PAXOS_REQUEST_QUEUE_HPP
 
+#include <list>
 #include <queue>
 
 #include <boost/function.hpp>
@@ -36,12 +37,18 @@ namespace paxos { namespace detail { namespace request_queue {
 
   To solve this problem, we provide this queue class. It is a bit of a "magic" queue: new
   requests put on this queue are automatically processed using the callback provided, and
-  it ensures a maximum of one request is processed at the same time.
+  it ensures a maximum of \c max_concurrent requests are processed at the same time. By default
+  this is one, but the leader can be configured to pipeline multiple proposals, in which case it
+  is up to the strategy to ensure these proposals are applied in order by the followers.
 
   The magic is in the fact that it provides a so-called "queue guard": the callback automatically
   gets this guard as part of its function parameters, and as soon as this guard goes out of scope,
   a new request is processed.
 
+  Optionally, a merge function can be provided that combines requests that are waiting in line
+  with the request that is about to be processed. The leader uses this to propose multiple
+  client requests in a single round.
+
   Since the thread putting new requests on the queue doesn't necessarily have to be the same
   thread as the one that pulls requests off the queue, this class is thread safe.
  */
@@ -61,58 +68,100 @@ public:
       
       static pointer
       create (
-         queue <Type> &    queue);
+         queue <Type> &                                 queue,
+         typename std::list <Type>::iterator            request);
    
    private:
       guard (
-         queue <Type> &    queue);
+         queue <Type> &                                 queue,
+         typename std::list <Type>::iterator            request);
       
    private:
       
-      queue <Type> &       queue_;
+      queue <Type> &                                    queue_;
+      typename std::list <Type>::iterator               request_;
    };
 
    typedef boost::function <void (Type const &, typename guard::pointer)>       callback;
 
+   /*!
+     \brief Merges the second request into the first one
+     \returns Returns false if the requests could not be merged, in which case the first
+              request is left untouched
+    */
+   typedef boost::function <bool (Type &, Type const &)>                        merge_function;
+
 public:
 
+   /*!
+     \param max_concurrent Maximum amount of requests that are processed at the same time
+     \param merge          Merges waiting requests into the request that is started, if any
+     \pre max_concurrent > 0
+    */
    queue (
-      callback  callback);
+      callback          callback,
+      size_t            max_concurrent = 1,
+      merge_function    merge = merge_function ());
 
    void
    push (
       Type &&  request);
 
+   /*!
+     \brief Merges requests that are waiting in line into \c request
+     \pre A merge function has been provided
+
+     This allows a callback to wait for more requests to arrive before it processes its own
+     request.
+    */
+   void
+   merge_waiting (
+      Type &    request);
+
+   /*!
+     \brief Called by the guard when \c request has been processed
+    */
    void
-   pop ();
+   pop (
+      typename std::list <Type>::iterator       request);
 
 private:
 
    /*!
      \returns Returns request that callback should be executed on, if any
     */
-   boost::optional <Type const &>
+   boost::optional <typename std::list <Type>::iterator>
    push_locked (
       Type &&  request);
 
    /*!
      \returns Returns request that callback should be executed on, if any
     */
-   boost::optional <Type const &>
-   pop_locked ();
+   boost::optional <typename std::list <Type>::iterator>
+   pop_locked (
+      typename std::list <Type>::iterator       request);
+
+   /*!
+     \brief Moves the first waiting request to the requests being processed
+    */
+   typename std::list <Type>::iterator
+   start_request_locked ();
 
+   /*!
+     \brief Merges requests that are waiting in line into \c request, as long as possible
+    */
    void
-   start_request_locked (
+   merge_waiting_locked (
       Type &    request);
 
-   
-
 private:
 
    callback             callback_;
+   size_t               max_concurrent_;
+   merge_function       merge_;
 
    /*!
-     \brief Synchronizes access to request_being_processed_ and queue_
+     \brief Synchronizes access to requests_being_processed_ and queue_
 
      We need a recursive_mutex since the callback is executed within a locked environment,
      but can in turn generate a push () request within that callback. When that occurs, if
@@ -120,7 +169,13 @@ private:
     */
    boost::mutex         mutex_;
 
-   bool                 request_being_processed_;
+   /*!
+     \brief Requests currently being processed
+
+     We use a list here since its iterators remain valid while other requests are added and
+     removed, and requests may finish in a different order than they were started.
+    */
+   std::list <Type>     requests_being_processed_;
    std::queue <Type>    queue_;
 };
 
@@ -4,15 +4,18 @@ namespace paxos { namespace detail { namespace request_queue {
 template <typename Type>
 /*! static */ typename queue <Type>::guard::pointer
 queue <Type>::guard::create (
-   queue <Type> &       queue)
+   queue <Type> &                               queue,
+   typename std::list <Type>::iterator          request)
 {
-   return pointer (new guard (queue));
+   return pointer (new guard (queue, request));
 }
 
 template <typename Type>
 inline queue <Type>::guard::guard (
-   queue <Type> &       queue)
-   : queue_ (queue)
+   queue <Type> &                               queue,
+   typename std::list <Type>::iterator          request)
+   : queue_ (queue),
+     request_ (request)
 {
 }
 
@@ -20,15 +23,19 @@ inline queue <Type>::guard::guard (
 template <typename Type>
 inline queue <Type>::guard::~guard ()
 {
-   queue_.pop ();
+   queue_.pop (request_);
 }
 
 template <typename Type>
 inline queue <Type>::queue (
-   callback  callback)
+   callback             callback,
+   size_t               max_concurrent,
+   merge_function       merge)
    : callback_ (callback),
-     request_being_processed_ (false)
+     max_concurrent_ (max_concurrent),
+     merge_ (merge)
 {
+   PAXOS_ASSERT (max_concurrent_ > 0);
 }
 
 
@@ -37,7 +44,7 @@ inline void
 queue <Type>::push (
    Type &&      input)
 {
-   boost::optional <Type const &> request;
+   boost::optional <typename std::list <Type>::iterator> request;
 
    {
       PAXOS_DEBUG ("push acquiring lock");
@@ -48,23 +55,34 @@ queue <Type>::push (
 
    if (request)
    {
-      callback_ (*request,
-                 guard::create (*this));
+      callback_ (**request,
+                 guard::create (*this, *request));
    }
 }
 
 
 template <typename Type>
-inline boost::optional <Type const &>
+inline void
+queue <Type>::merge_waiting (
+   Type &       request)
+{
+   PAXOS_ASSERT (merge_.empty () == false);
+
+   boost::mutex::scoped_lock lock (mutex_);
+   merge_waiting_locked (request);
+}
+
+
+template <typename Type>
+inline boost::optional <typename std::list <Type>::iterator>
 queue <Type>::push_locked (
    Type &&      request)
 {
    queue_.push (request);
 
-   if (request_being_processed_ == false)
+   if (requests_being_processed_.size () < max_concurrent_)
    {
-      this->start_request_locked (request);
-      return request;
+      return this->start_request_locked ();
    }
 
    return boost::none;
@@ -74,55 +92,72 @@ queue <Type>::push_locked (
 
 template <typename Type>
 inline void
-queue <Type>::pop ()
+queue <Type>::pop (
+   typename std::list <Type>::iterator  finished)
 {
-   boost::optional <Type const &> request;
+   boost::optional <typename std::list <Type>::iterator> request;
    {
       PAXOS_DEBUG ("pop acquiring lock");
       boost::mutex::scoped_lock lock (mutex_);
-      request = pop_locked ();
+      request = pop_locked (finished);
       PAXOS_DEBUG ("pop releasing lock");
    }
 
    if (request)
    {
-      callback_ (*request,
-                 guard::create (*this));
+      callback_ (**request,
+                 guard::create (*this, *request));
    }
 }
 
 template <typename Type>
-inline boost::optional <Type const &>
-queue <Type>::pop_locked ()
+inline boost::optional <typename std::list <Type>::iterator>
+queue <Type>::pop_locked (
+   typename std::list <Type>::iterator  finished)
 {
-   PAXOS_ASSERT (queue_.empty () == false);
-   PAXOS_ASSERT (request_being_processed_ == true);
+   PAXOS_ASSERT (requests_being_processed_.empty () == false);
 
-   queue_.pop ();
-   request_being_processed_ = false;
+   requests_being_processed_.erase (finished);
 
    if (queue_.empty () == false)
    {
       /*!
         This means we still have requests waiting in line
       */
-      Type & request = queue_.front ();
+      return this->start_request_locked ();
+   }
+
+   return boost::none;
+}
 
-      this->start_request_locked (request);
+template <typename Type>
+inline typename std::list <Type>::iterator
+queue <Type>::start_request_locked ()
+{
+   PAXOS_ASSERT (queue_.empty () == false);
+   PAXOS_ASSERT (requests_being_processed_.size () < max_concurrent_);
+
+   requests_being_processed_.push_back (std::move (queue_.front ()));
+   queue_.pop ();
 
-      return request;
+   if (merge_.empty () == false)
+   {
+      merge_waiting_locked (requests_being_processed_.back ());
    }
 
-   return boost::none;
+   return --requests_being_processed_.end ();
 }
+
 template <typename Type>
 inline void
-queue <Type>::start_request_locked (
+queue <Type>::merge_waiting_locked (
    Type &       request)
 {
-   PAXOS_ASSERT (request_being_processed_ == false);
-
-   request_being_processed_ = true;     
+   while (queue_.empty () == false
+          && merge_ (request, queue_.front ()) == true)
+   {
+      queue_.pop ();
+   }
 }
 
 }; }; };
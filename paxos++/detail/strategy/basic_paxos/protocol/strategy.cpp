@@ -1,8 +1,10 @@
+#include <algorithm>
 #include <functional>
 
 #include <boost/uuid/uuid_io.hpp>
 
 #include "../../../../durable/storage.hpp"
+#include "../../../../exception/exception.hpp"
 #include "../../../quorum/server_view.hpp"
 #include "../../../paxos_context.hpp"
 #include "../../../command.hpp"
@@ -17,14 +19,14 @@ namespace paxos { namespace detail { namespace strategy { namespace basic_paxos
 
 strategy::strategy (
    durable::storage &   storage)
-   : storage_ (storage)
+   : storage_ (storage),
+     recovering_ (false)
 {
 }
 
 /*! virtual */ void
 strategy::initiate (      
-   tcp_connection_ptr                   client_connection,
-   detail::command const &              command,
+   std::vector <client_request> const & clients,
    detail::quorum::server_view &        quorum,
    detail::paxos_context &              global_state,
    queue_guard_type                     queue_guard)
@@ -38,27 +40,33 @@ strategy::initiate (
    {
       this->handle_error (detail::error_no_majority,
                           quorum,
-                          client_connection);
+                          clients);
+      return;
+   }
+
+   if (this->defer_request (clients,
+                            quorum,
+                            global_state,
+                            queue_guard) == true)
+   {
       return;
    }
 
    /*!
      Keeps track of the current state / which servers have responded, etc.
-    */
-   boost::shared_ptr <struct state> state (new struct state ());
 
-   /*!
      Note that this will ensure the queue guard is in place for as long as the request is
      being processed.
     */
-   state->queue_guard = queue_guard;
+   boost::shared_ptr <struct state> state = this->create_state (clients,
+                                                                queue_guard);
 
    std::vector <boost::asio::ip::tcp::endpoint> live_servers = quorum.live_servers ();
    if (live_servers.empty () == true)
    {
       handle_error (detail::error_no_leader,
                     quorum,
-                    client_connection);
+                    clients);
       return;
    }
 
@@ -73,27 +81,148 @@ strategy::initiate (
 
       PAXOS_DEBUG ("sending paxos request to server " << endpoint);
 
-      send_prepare (client_connection,
-                    command,
-                    server.endpoint (),
+      send_prepare (server.endpoint (),
                     server.connection (),
                     quorum,
                     global_state,
-                    command.workload (),
                     state);
    }
 }
 
 
+boost::shared_ptr <struct strategy::state>
+strategy::create_state (
+   std::vector <client_request> const & clients,
+   queue_guard_type                     queue_guard)
+{
+   PAXOS_ASSERT (clients.empty () == false);
+
+   int64_t proposal_id = this->proposal_id ();
+
+   if (proposals_in_progress_.empty () == false)
+   {
+      proposal_id = std::max (proposal_id,
+                              *proposals_in_progress_.rbegin ());
+   }
+
+   ++proposal_id;
+
+   PAXOS_DEBUG ("allocated " << clients.size () << " proposal ids starting at " << proposal_id << ", " << proposals_in_progress_.size () << " other proposals in progress");
+
+   for (size_t i = 0; i < clients.size (); ++i)
+   {
+      proposals_in_progress_.insert (proposal_id + i);
+   }
+
+   boost::shared_ptr <struct state> state (new struct state (),
+                                           std::bind (&strategy::destroy_state,
+                                                      this,
+                                                      std::placeholders::_1));
+   state->proposal_id = proposal_id;
+   state->clients     = clients;
+   state->succeeded   = false;
+   state->accept_sent = false;
+   state->replied     = false;
+   state->queue_guard = queue_guard;
+
+   return state;
+}
+
+
+bool
+strategy::defer_request (
+   std::vector <client_request> const & clients,
+   detail::quorum::server_view &        quorum,
+   detail::paxos_context &              global_state,
+   queue_guard_type                     queue_guard)
+{
+   if (recovering_ == false)
+   {
+      return false;
+   }
+
+   PAXOS_ASSERT (proposals_in_progress_.empty () == false);
+
+   PAXOS_DEBUG ("deferring request until " << proposals_in_progress_.size () << " proposals have finished");
+
+   deferred_requests_.push_back (
+      std::bind (&strategy::initiate,
+                 this,
+                 clients,
+                 std::ref (quorum),
+                 std::ref (global_state),
+                 queue_guard));
+
+   return true;
+}
+
+void
+strategy::destroy_state (
+   struct state *       state)
+{
+   /*!
+     Release the proposal id before the queue guard goes out of scope, since that might start
+     the next request immediately.
+    */
+   for (size_t i = 0; i < state->clients.size (); ++i)
+   {
+      PAXOS_ASSERT (proposals_in_progress_.find (state->proposal_id + i) != proposals_in_progress_.end ());
+      proposals_in_progress_.erase (state->proposal_id + i);
+   }
+
+   /*!
+     Followers that were waiting for the proposals before theirs can now continue, when
+     those have all finished.
+    */
+   std::vector <boost::function <void ()> > deferred_accepts;
+
+   for (auto i = deferred_accepts_.begin (); i != deferred_accepts_.end ();)
+   {
+      if (proposals_in_progress_.empty () == true
+          || *proposals_in_progress_.begin () >= i->first)
+      {
+         deferred_accepts.push_back (i->second);
+         i = deferred_accepts_.erase (i);
+      }
+      else
+      {
+         ++i;
+      }
+   }
+
+   for (boost::function <void ()> const & accept : deferred_accepts)
+   {
+      accept ();
+   }
+
+   if (proposals_in_progress_.empty () == true)
+   {
+      recovering_ = false;
+
+      std::vector <boost::function <void ()> > deferred_requests;
+      std::swap (deferred_requests, deferred_requests_);
+
+      for (boost::function <void ()> const & request : deferred_requests)
+      {
+         request ();
+      }
+   }
+   else if (state->succeeded == false)
+   {
+      PAXOS_WARN ("proposal " << state->proposal_id << " failed while " << proposals_in_progress_.size () << " other proposals are in progress");
+      recovering_ = true;
+   }
+
+   delete state;
+}
+
+
 /*! virtual */ void
 strategy::send_prepare (
-   tcp_connection_ptr                           client_connection,
-   detail::command const &                      client_command,
    boost::asio::ip::tcp::endpoint const &       follower_endpoint,
    tcp_connection_ptr                           follower_connection,
    detail::quorum::server_view &                quorum,
    detail::paxos_context &                      global_state,
-   std::string const &                          byte_array,
    boost::shared_ptr <struct state>             state)
 {
 
@@ -112,7 +241,7 @@ strategy::send_prepare (
    command command;
 
    command.set_type (command::type_request_prepare);
-   command.set_next_proposal_id (this->proposal_id () + 1);
+   command.set_next_proposal_id (state->proposal_id);
 
    this->add_local_host_information (quorum, command);
 
@@ -130,13 +259,10 @@ strategy::send_prepare (
       std::bind (&strategy::receive_promise,
                  this,
                  std::placeholders::_1,
-                 client_connection,
-                 client_command,
                  follower_endpoint,
                  follower_connection,
                  std::ref (quorum),
                  std::ref (global_state),
-                 byte_array,
                  std::placeholders::_2,
                  state));
 }
@@ -147,6 +273,20 @@ strategy::prepare (
    detail::command const &              command,
    detail::quorum::server_view &        quorum,
    detail::paxos_context &              state)
+{
+   detail::command response = this->process_prepare (command,
+                                                     quorum);
+
+   PAXOS_DEBUG ("step3 writing command");   
+
+   leader_connection->write_command (response);
+}
+
+
+/*! virtual */ detail::command
+strategy::process_prepare (
+   detail::command const &              command,
+   detail::quorum::server_view &        quorum)
 {
    this->process_remote_host_information (command,
                                           quorum);
@@ -197,23 +337,17 @@ strategy::prepare (
 
    this->add_local_host_information (quorum, response);
 
-
-   PAXOS_DEBUG ("step3 writing command");   
-
-   leader_connection->write_command (response);
+   return response;
 }
 
 
 /*! virtual */ void
 strategy::receive_promise (
    boost::optional <enum detail::error_code>    error,
-   tcp_connection_ptr                           client_connection,
-   detail::command                              client_command,
    boost::asio::ip::tcp::endpoint const &       follower_endpoint,
    tcp_connection_ptr                           follower_connection,
    detail::quorum::server_view &                quorum,
    detail::paxos_context &                      global_state,
-   std::string                                  byte_array,
    detail::command const &                      command,
    boost::shared_ptr <struct state>             state)
 {
@@ -261,6 +395,16 @@ strategy::receive_promise (
       };
    }
 
+   if (global_state.commit_on_majority () == true)
+   {
+      this->decide_promise_on_majority (follower_endpoint,
+                                        follower_connection,
+                                        quorum,
+                                        global_state,
+                                        state);
+      return;
+   }
+
    if (state->connections.size () == state->accepted.size ())
    {
    
@@ -295,13 +439,10 @@ strategy::receive_promise (
          
          for (auto & i : state->connections)
          {
-            send_accept (client_connection,
-                         client_command,
-                         i.first,
+            send_accept (i.first,
                          i.second,
                          quorum,
                          std::ref (global_state),
-                         byte_array,
                          state);
          }
       }
@@ -315,20 +456,17 @@ strategy::receive_promise (
          */
          handle_error (*last_error,
                        quorum,
-                       client_connection);
+                       state->clients);
       }
    }
 }
 
 /*! virtual */ void
 strategy::send_accept (
-   tcp_connection_ptr                           client_connection,
-   detail::command const &                      client_command,
    boost::asio::ip::tcp::endpoint const &       follower_endpoint,
    tcp_connection_ptr                           follower_connection,
    detail::quorum::server_view &                quorum,
    detail::paxos_context &                      global_state,
-   std::string const &                          byte_array,
    boost::shared_ptr <struct state>             state)
 {  
    PAXOS_ASSERT_EQ (state->connections[follower_endpoint], follower_connection);
@@ -346,25 +484,87 @@ strategy::send_accept (
       quorum.lookup_server (follower_endpoint).highest_proposal_id ();
 
    /*!
-     Note that the storage mechanism is *not* required to retrieve all data, it
-     can just retrieve a portion. This prevents the whole quorum from locking up
-     if we need to transfer lots of data to a single follower.
+     When multiple proposals are in progress, the follower might not have told us yet
+     that it has accepted the proposals we sent it earlier. Those are already on their way
+     to the follower, so we must not send them again as history.
+    */
+   if (sent_proposal_ids_.find (follower_endpoint) != sent_proposal_ids_.end ())
+   {
+      follower_highest_proposal_id = std::max (follower_highest_proposal_id,
+                                               sent_proposal_ids_[follower_endpoint]);
+   }
+
+   /*!
+     Note that the storage mechanism only retrieves a limited batch of history. This
+     prevents the whole quorum from locking up if we need to transfer lots of data to a
+     single follower.
+    */
+   std::map <int64_t, std::string> history = 
+      storage_.retrieve (follower_highest_proposal_id);
+
+   history.erase (history.lower_bound (state->proposal_id),
+                  history.end ());
+
+   int64_t history_end = 
+      history.empty () == true ? follower_highest_proposal_id : history.rbegin ()->first;
+
+   if (history_end < state->proposal_id - 1
+       && history_end >= storage_.highest_proposal_id ())
+   {
+      /*!
+        The follower misses proposals that we have not stored ourselves yet, which happens
+        when it reconnects while other proposals are in progress. We cannot send it our
+        proposal before it has those, so we try again once they have finished.
+       */
+      if (proposals_in_progress_.empty () == false
+          && *proposals_in_progress_.begin () < state->proposal_id)
+      {
+         PAXOS_DEBUG ("deferring accept to follower " << follower_endpoint << " until the proposals before " << state->proposal_id << " have finished");
+
+         deferred_accepts_.push_back (
+            std::make_pair (state->proposal_id,
+                            std::bind (&strategy::send_accept,
+                                       this,
+                                       follower_endpoint,
+                                       follower_connection,
+                                       std::ref (quorum),
+                                       std::ref (global_state),
+                                       state)));
+         return;
+      }
+
+      /*!
+        The proposals before ours have failed, so the follower will never be able to accept
+        ours; we send it on its own, which the follower then rejects.
+       */
+      history.clear ();
+   }
+
+   /*!
+     If there is more history than a single batch, we send this batch on its own, and
+     continue with the next batch once the follower has accepted this one.
     */
-   command.set_proposed_workload (
-      storage_.retrieve (follower_highest_proposal_id));
+   bool catching_up =
+      history.empty () == false
+      && history.rbegin ()->first < state->proposal_id - 1;
+
+   command.set_proposed_workload (history);
 
    if (command.proposed_workload ().empty () == true
-       || command.proposed_workload ().rbegin ()->first == this->proposal_id ())
+       || command.proposed_workload ().rbegin ()->first == state->proposal_id - 1)
    {
       /*!
         This means that either there was no historical data available for the 
         follower (the most likely case, because that means the follower is up-to-date),
         or it just means the next request will catch him up completely.
 
-        Either way, let's store our currently proposed value too!
+        Either way, let's store our currently proposed values too!
        */
-      command.add_proposed_workload (this->proposal_id () + 1,
-                                     byte_array);
+      for (size_t i = 0; i < state->clients.size (); ++i)
+      {
+         command.add_proposed_workload (state->proposal_id + i,
+                                        state->clients[i].command_.workload ());
+      }
    }   
 
    /*!
@@ -378,12 +578,31 @@ strategy::send_accept (
 
    this->add_local_host_information (quorum, command);
 
+   sent_proposal_ids_[follower_endpoint] = command.proposed_workload ().rbegin ()->first;
+
    PAXOS_DEBUG ("step5 writing command");   
 
    follower_connection->write_command (command);
    
    PAXOS_DEBUG ("step5 reading command");   
 
+   if (catching_up == true)
+   {
+      PAXOS_DEBUG ("sent " << history.size () << " proposals of history to follower " << follower_endpoint);
+
+      follower_connection->read_command (
+         std::bind (&strategy::receive_catchup,
+                    this,
+                    std::placeholders::_1,
+                    follower_endpoint,
+                    follower_connection,
+                    std::ref (quorum),
+                    std::ref (global_state),
+                    std::placeholders::_2,
+                    state));
+      return;
+   }
+
    /*!
      We expect a response to this command.
     */
@@ -391,16 +610,61 @@ strategy::send_accept (
       std::bind (&strategy::receive_accepted,
                  this,
                  std::placeholders::_1,
-                 client_connection,
-                 client_command,
                  follower_endpoint,
                  std::ref (quorum),
+                 std::ref (global_state),
                  std::placeholders::_2,
                  state));
 
 }
 
 
+/*! virtual */ void
+strategy::receive_catchup (
+   boost::optional <enum detail::error_code>    error,
+   boost::asio::ip::tcp::endpoint const &       follower_endpoint,
+   tcp_connection_ptr                           follower_connection,
+   detail::quorum::server_view &                quorum,
+   detail::paxos_context &                      global_state,
+   detail::command const &                      command,
+   boost::shared_ptr <struct state>             state)
+{
+   if (error || command.type () != command::type_request_accepted)
+   {
+      /*!
+        A follower that fails to catch up fails our proposal, just like a follower that
+        fails to accept it.
+       */
+      this->receive_accepted (error,
+                              follower_endpoint,
+                              quorum,
+                              global_state,
+                              command,
+                              state);
+      return;
+   }
+
+   /*!
+     This tells us how far the follower has caught up, so that the next call to
+     send_accept () continues from there.
+    */
+   this->process_remote_host_information (command,
+                                          quorum);
+
+   if (command.proposed_workload ().empty () == true
+       || command.proposed_workload ().rbegin ()->first >= sent_proposal_ids_[follower_endpoint])
+   {
+      sent_proposal_ids_.erase (follower_endpoint);
+   }
+
+   this->send_accept (follower_endpoint,
+                      follower_connection,
+                      quorum,
+                      global_state,
+                      state);
+}
+
+
 /*! virtual */ void
 strategy::accept (      
    tcp_connection_ptr                   leader_connection,
@@ -412,14 +676,32 @@ strategy::accept (
                                           quorum);
 
    detail::command response;
+
+   PAXOS_ASSERT_EQ (command.proposed_workload ().empty (), false);
+
+   if (command.proposed_workload ().begin ()->first != this->proposal_id () + 1)
+   {
+      /*!
+        We can only apply proposals in order. This occurs when the leader has multiple
+        proposals in progress and one of the proposals before this one failed: all proposals
+        after it will fail too, until the leader has caught up again.
+       */
+      PAXOS_WARN ("follower " << quorum.our_endpoint () << " received proposal id " << command.proposed_workload ().begin ()->first << ", but our highest proposal id = " << this->proposal_id ());
+
+      response.set_type (command::type_request_fail);
+      response.set_error_code (detail::error_incorrect_proposal);
+
+      this->add_local_host_information (quorum, response);
+
+      leader_connection->write_command (response);
+      return;
+   }
    
    /*!
      Default to an 'accepted' response
    */
    response.set_type (command::type_request_accepted);
 
-   PAXOS_ASSERT_EQ (command.proposed_workload ().empty (), false);
-
    for (auto const & i : command.proposed_workload ())
    {
       PAXOS_DEBUG ("follower " << quorum.our_endpoint () << " storing proposed workload for id = " << i.first << ", our highest proposal_id = " << this->proposal_id ());
@@ -440,9 +722,29 @@ strategy::accept (
         proposal/value in our durable storage backend so other nodes can catch up 
         if they're disconnected for a short timespan.
       */
-      storage_.accept (i.first,
-                       i.second,
-                       command.lowest_proposal_id ());
+      try
+      {
+         storage_.accept (i.first,
+                          i.second,
+                          command.lowest_proposal_id ());
+      }
+      catch (exception::storage_error const &)
+      {
+         /*!
+           We cannot tell the leader we have accepted a proposal we might lose; it will try
+           again, or let us catch up, in a later round.
+          */
+         PAXOS_WARN ("follower " << quorum.our_endpoint () << " was unable to store proposal id " << i.first);
+
+         detail::command error;
+         error.set_type (command::type_request_fail);
+         error.set_error_code (detail::error_storage);
+
+         this->add_local_host_information (quorum, error);
+
+         leader_connection->write_command (error);
+         return;
+      }
 
       /*!
         This is a bit of a hack, but we need to let the quorum know that our own
@@ -470,10 +772,9 @@ strategy::accept (
 /*! virtual */ void
 strategy::receive_accepted (
    boost::optional <enum detail::error_code>    error,
-   tcp_connection_ptr                           client_connection,
-   detail::command                              client_command,
    boost::asio::ip::tcp::endpoint const &       follower_endpoint,
    detail::quorum::server_view &                quorum,
+   detail::paxos_context &                      global_state,
    detail::command const &                      command,
    boost::shared_ptr <struct state>             state)
 {
@@ -483,15 +784,29 @@ strategy::receive_accepted (
 
       quorum.connection_died (follower_endpoint);
 
+      sent_proposal_ids_.erase (follower_endpoint);
+
       state->accepted[follower_endpoint]    = response_reject;
       state->error_codes[follower_endpoint] = *error;
-      state->responses[follower_endpoint]   = std::string ();
+      state->responses[follower_endpoint]   = std::map <int64_t, std::string> ();
    }
    else
    {
       this->process_remote_host_information (command,
                                              quorum);
 
+      /*!
+        Once the follower has replied to everything we sent it, or has failed one of our
+        proposals (and with it everything sent after it), the highest proposal id it has
+        told us about is accurate again.
+       */
+      if (command.type () != command::type_request_accepted
+          || command.proposed_workload ().empty () == true
+          || command.proposed_workload ().rbegin ()->first >= sent_proposal_ids_[follower_endpoint])
+      {
+         sent_proposal_ids_.erase (follower_endpoint);
+      }
+
       /*!
         The state is set to 'accepted' in the previous promise phase, otherwise we
         shouldn't have reached this step at all.
@@ -509,19 +824,20 @@ strategy::receive_accepted (
 
                /*!
                  Always store the response we received, since we also use that entry to see
-                 whether all hosts have already replied. 
+                 whether all hosts have already replied. Note that the follower might also
+                 have sent us responses to history it has caught up with, which we are not
+                 interested in.
                */
-               state->responses[follower_endpoint]   = 
-                  command.proposed_workload ().rbegin ()->second;
-
-               PAXOS_ASSERT_EQ (state->responses[follower_endpoint].empty (), false);
+               state->responses[follower_endpoint]   = std::map <int64_t, std::string> (
+                  command.proposed_workload ().lower_bound (state->proposal_id),
+                  command.proposed_workload ().end ());
 
                break;
 
             case command::type_request_fail:
                state->accepted[follower_endpoint]    = response_reject;
                state->error_codes[follower_endpoint] = command.error_code ();
-               state->responses[follower_endpoint]   = std::string ();
+               state->responses[follower_endpoint]   = std::map <int64_t, std::string> ();
                break;
 
             default:
@@ -533,11 +849,16 @@ strategy::receive_accepted (
    }
 
 
-   PAXOS_DEBUG ("leader got response = " << state->responses[follower_endpoint] << ", follower = " << follower_endpoint);
-
-
+   PAXOS_DEBUG ("leader got " << state->responses[follower_endpoint].size () << " responses from follower = " << follower_endpoint);
 
-   std::string workload;
+   if (global_state.commit_on_majority () == true)
+   {
+      this->decide_accepted_on_majority (follower_endpoint,
+                                         quorum,
+                                         global_state,
+                                         state);
+      return;
+   }
 
    if (state->connections.size () == state->responses.size ())
    {
@@ -556,42 +877,14 @@ strategy::receive_accepted (
             PAXOS_ASSERT_NE (*last_error, detail::no_error);
          }
       }
-      
-      if (last_error.is_initialized () == false)
-      {
-         /*!
-           One of the requirements of our protocol is that if one node N1 replies
-           to proposal P with response R, node N2 must have the exact same response
-           for the same proposal.
-           
-           The code below validates this requirement.
-         */
-         for (auto const & i : state->responses)
-         {
-            if (workload.empty () == true)
-            {
-               workload = i.second;
-               PAXOS_ASSERT (workload.empty () == false);
-            }
-            else if (workload != i.second)
-            {
-               last_error = detail::error_inconsistent_response;
-            }
-
-         }
-      }
 
       if (last_error.is_initialized () == false)
       {
          PAXOS_DEBUG ("step7 writing command");   
-         detail::command response;
-         response.set_type (command::type_request_accepted);
-         response.set_workload (workload);
-
-         this->add_local_host_information (quorum,
-                                           response);
+         state->succeeded = true;
 
-         client_connection->write_command (response);
+         this->send_responses (quorum,
+                               state);
       }
       else
       {
@@ -606,17 +899,269 @@ strategy::receive_accepted (
 
          handle_error (*last_error,
                        quorum,
-                       client_connection);
+                       state->clients);
+      }
+   }
+}
+
+
+void
+strategy::decide_promise_on_majority (
+   boost::asio::ip::tcp::endpoint const &       follower_endpoint,
+   tcp_connection_ptr                           follower_connection,
+   detail::quorum::server_view &                quorum,
+   detail::paxos_context &                      global_state,
+   boost::shared_ptr <struct state>             state)
+{
+   if (state->accepted.find (follower_endpoint)->second == response_reject)
+   {
+      /*!
+        This follower will not take part in the 'accept' phase, so we will never receive a
+        response from it; mark it as done already.
+       */
+      state->responses[follower_endpoint] = std::map <int64_t, std::string> ();
+
+      if (state->accept_sent == true)
+      {
+         this->decide_accepted_on_majority (follower_endpoint,
+                                            quorum,
+                                            global_state,
+                                            state);
+         return;
+      }
+   }
+   else if (state->accept_sent == true)
+   {
+      /*!
+        The majority has already promised and is processing our proposal; let this
+        follower catch up with them.
+       */
+      this->send_accept (follower_endpoint,
+                         follower_connection,
+                         quorum,
+                         global_state,
+                         state);
+      return;
+   }
+
+   if (state->replied == true)
+   {
+      return;
+   }
+
+   size_t                            promises = 0;
+   boost::optional <enum error_code> last_error;
+
+   for (auto const & i : state->accepted)
+   {
+      if (i.second == response_ack)
+      {
+         ++promises;
+      }
+      else
+      {
+         PAXOS_ASSERT (state->error_codes.find (i.first) != state->error_codes.end ());
+         last_error = state->error_codes.find (i.first)->second;
+      }
+   }
+
+   if (quorum.is_majority (promises) == true)
+   {
+      state->accept_sent = true;
+
+      for (auto & i : state->connections)
+      {
+         auto promise = state->accepted.find (i.first);
+
+         if (promise != state->accepted.end ()
+             && promise->second == response_ack)
+         {
+            send_accept (i.first,
+                         i.second,
+                         quorum,
+                         global_state,
+                         state);
+         }
+      }
+   }
+   else if (state->connections.size () == state->accepted.size ())
+   {
+      state->replied = true;
+
+      handle_error (last_error.is_initialized () == true ? *last_error : detail::error_no_majority,
+                    quorum,
+                    state->clients);
+   }
+}
+
+
+void
+strategy::decide_accepted_on_majority (
+   boost::asio::ip::tcp::endpoint const &       follower_endpoint,
+   detail::quorum::server_view &                quorum,
+   detail::paxos_context &                      global_state,
+   boost::shared_ptr <struct state>             state)
+{
+   if (state->replied == true)
+   {
+      if (state->succeeded == false)
+      {
+         return;
+      }
+
+      if (state->accepted.find (follower_endpoint)->second != response_ack)
+      {
+         PAXOS_WARN ("follower " << follower_endpoint << " failed to process proposal " << state->proposal_id << " after it was committed");
+         return;
+      }
+
+      /*!
+        The clients already have their response, so all we can do is report any follower
+        that does not agree with it.
+       */
+      for (auto const & i : state->responses.find (follower_endpoint)->second)
+      {
+         auto committed = state->committed_responses.find (i.first);
+
+         if (committed != state->committed_responses.end ()
+             && committed->second != i.second)
+         {
+            PAXOS_WARN ("follower " << follower_endpoint << " diverged from committed response for proposal " << i.first);
+
+            if (global_state.divergence_callback ())
+            {
+               global_state.divergence_callback () (i.first,
+                                                    follower_endpoint,
+                                                    committed->second,
+                                                    i.second);
+            }
+         }
+      }
+
+      return;
+   }
+
+   size_t                            accepts = 0;
+   boost::optional <enum error_code> last_error;
+
+   for (auto const & i : state->responses)
+   {
+      if (state->accepted.find (i.first)->second == response_ack)
+      {
+         ++accepts;
+      }
+      else
+      {
+         PAXOS_ASSERT (state->error_codes.find (i.first) != state->error_codes.end ());
+         last_error = state->error_codes.find (i.first)->second;
+      }
+   }
+
+   if (quorum.is_majority (accepts) == true)
+   {
+      PAXOS_DEBUG ("proposal " << state->proposal_id << " accepted by " << accepts << " out of " << state->connections.size () << " followers");
+
+      state->replied   = true;
+      state->succeeded = true;
+
+      this->send_responses (quorum,
+                            state);
+
+      /*!
+        The remaining followers should not hold up the next request, so release our place in
+        the request queue already. Note that our proposal id stays allocated until the last
+        follower has replied.
+       */
+      state->queue_guard.reset ();
+   }
+   else if (state->connections.size () == state->responses.size ())
+   {
+      state->replied = true;
+
+      handle_error (last_error.is_initialized () == true ? *last_error : detail::error_no_majority,
+                    quorum,
+                    state->clients);
+   }
+}
+
+
+/*! virtual */ void
+strategy::send_responses (
+   quorum::server_view const &          quorum,
+   boost::shared_ptr <struct state>     state)
+{
+   for (size_t i = 0; i < state->clients.size (); ++i)
+   {
+      int64_t           proposal_id = state->proposal_id + i;
+      std::string       workload;
+      bool              consistent  = true;
+
+      /*!
+        One of the requirements of our protocol is that if one node N1 replies
+        to proposal P with response R, node N2 must have the exact same response
+        for the same proposal.
+           
+        The code below validates this requirement.
+       */
+      for (auto const & j : state->responses)
+      {
+         if (state->accepted.find (j.first)->second != response_ack)
+         {
+            /*!
+              When committing on a majority, we can reply while some followers have
+              rejected our proposal.
+             */
+            continue;
+         }
+
+         auto response = j.second.find (proposal_id);
+
+         if (response == j.second.end ())
+         {
+            /*!
+              This occurs when a follower was still catching up, and we did not send
+              it our proposal yet.
+             */
+            consistent = false;
+         }
+         else if (workload.empty () == true)
+         {
+            workload = response->second;
+            PAXOS_ASSERT (workload.empty () == false);
+         }
+         else if (workload != response->second)
+         {
+            consistent = false;
+         }
+      }
+
+      if (consistent == false)
+      {
+         handle_error (detail::error_inconsistent_response,
+                       quorum,
+                       {state->clients[i]});
+         continue;
       }
+
+      state->committed_responses[proposal_id] = workload;
+
+      detail::command response;
+      response.set_type (command::type_request_accepted);
+      response.set_workload (workload);
+
+      this->add_local_host_information (quorum,
+                                        response);
+
+      state->clients[i].connection_->write_command (response);
    }
 }
 
 
 /*! virtual */ void
 strategy::handle_error (
-   enum detail::error_code      error,
-   quorum::server_view const &  quorum,
-   tcp_connection_ptr           client_connection)
+   enum detail::error_code              error,
+   quorum::server_view const &          quorum,
+   std::vector <client_request> const & clients)
 {
    detail::command response;
    response.set_type (command::type_request_error);
@@ -625,7 +1170,10 @@ strategy::handle_error (
    this->add_local_host_information (quorum,
                                      response);
 
-   client_connection->write_command (response);   
+   for (client_request const & client : clients)
+   {
+      client.connection_->write_command (response);   
+   }
 }
 
 
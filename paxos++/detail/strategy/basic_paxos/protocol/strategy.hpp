@@ -5,6 +5,11 @@
 #ifndef LIBPAXOS_CPP_DETAIL_STRATEGY_BASIC_PAXOS_PROTOCOL_STRATEGY_HPP
 #define LIBPAXOS_CPP_DETAIL_STRATEGY_BASIC_PAXOS_PROTOCOL_STRATEGY_HPP
 
+#include <set>
+#include <vector>
+
+#include <boost/function.hpp>
+
 #include <boost/asio/ip/tcp.hpp>
 
 #include "../../../error.hpp"
@@ -21,7 +26,7 @@ namespace paxos { namespace detail { namespace strategy { namespace basic_paxos
  */
 class strategy : public detail::strategy::strategy
 {
-private:
+protected:
    enum response
    {
       response_none,
@@ -31,8 +36,47 @@ private:
 
    struct state
    {
+      /*!
+        \brief The first proposal id allocated for this request, see create_state ()
+
+        Every client workload in this request gets its own proposal id; these are consecutive
+        and start at this proposal id.
+       */
+      int64_t                                                                   proposal_id;
+
+      /*!
+        \brief The clients that are waiting for the result of this request
+       */
+      std::vector <client_request>                                              clients;
+
+      /*!
+        \brief Set when all followers have accepted our proposal
+       */
+      bool                                                                      succeeded;
+
+      /*!
+        \brief Set when the followers that promised have been sent an 'accept' command
+
+        Only used when committing on a majority, in which case followers that promise after
+        this point are sent an 'accept' command right away.
+       */
+      bool                                                                      accept_sent;
+
+      /*!
+        \brief Set when the clients have received either their response or an error
+
+        Only used when committing on a majority, in which case some followers can still reply
+        after this point.
+       */
+      bool                                                                      replied;
+
+      /*!
+        \brief The responses sent to the clients, by proposal id
+       */
+      std::map <int64_t, std::string>                                           committed_responses;
+
       std::map <boost::asio::ip::tcp::endpoint, enum response>                  accepted;
-      std::map <boost::asio::ip::tcp::endpoint, std::string>                    responses;
+      std::map <boost::asio::ip::tcp::endpoint, std::map <int64_t, std::string> > responses;
       std::map <boost::asio::ip::tcp::endpoint, enum detail::error_code>        error_codes;
       std::map <boost::asio::ip::tcp::endpoint, detail::tcp_connection_ptr>     connections;
       queue_guard_type                                                          queue_guard;
@@ -44,12 +88,11 @@ public:
       durable::storage &        storage);
 
    /*!
-     \brief Received by leader from client that initiates a request
+     \brief Received by leader from one or more clients that initiate a request
     */
    virtual void
    initiate (      
-      tcp_connection_ptr                        client_connection,
-      detail::command const &                   command,
+      std::vector <client_request> const &      clients,
       detail::quorum::server_view &             quorum,
       detail::paxos_context &                   global_state,
       queue_guard_type                          queue_guard);
@@ -82,18 +125,51 @@ public:
 
 protected:
 
+   /*!
+     \brief Creates the state of a new request and allocates a proposal id for it
+
+     When the leader has multiple proposals in progress, each of them gets its own proposal id,
+     which is one higher than any proposal id currently in progress. The proposal id is released
+     again as soon as the returned state goes out of scope.
+    */
+   boost::shared_ptr <struct state>
+   create_state (
+      std::vector <client_request> const &      clients,
+      queue_guard_type                          queue_guard);
+
+   /*!
+     \brief Defers a request while proposals after a failed proposal are still in progress
+     \returns Returns true if the request was deferred, in which case it is initiated again later
+
+     When a proposal fails, the followers will reject all proposals in progress after it, since
+     they can only accept proposals in order. Rather than allocating proposal ids after those, we
+     wait until all of them have finished and continue with the proposal id that failed.
+    */
+   bool
+   defer_request (
+      std::vector <client_request> const &      clients,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state,
+      queue_guard_type                          queue_guard);
+
+   /*!
+     \brief Validates a 'prepare' command received from a leader
+     \returns Returns either a 'promise' or a 'fail' response that should be sent back to the leader
+    */
+   virtual detail::command
+   process_prepare (
+      detail::command const &                   command,
+      detail::quorum::server_view &             quorum);
+
    /*!
      \brief Sends a 'prepare' to a specific server
     */
    virtual void
    send_prepare (
-      tcp_connection_ptr                        client_connection,
-      detail::command const &                   client_command,
       boost::asio::ip::tcp::endpoint const &    follower_endpoint,
       tcp_connection_ptr                        follower_connection,
       detail::quorum::server_view &             quorum,
       detail::paxos_context &                   global_state,
-      std::string const &                       byte_array,
       boost::shared_ptr <struct state>          state);
 
 
@@ -103,13 +179,10 @@ protected:
    virtual void
    receive_promise (
       boost::optional <enum detail::error_code> error,
-      tcp_connection_ptr                        client_connection,
-      detail::command                           client_command,
       boost::asio::ip::tcp::endpoint const &    follower_endpoint,
       tcp_connection_ptr                        follower_connection,
       detail::quorum::server_view &             quorum,
       detail::paxos_context &                   global_state,
-      std::string                               byte_array,
       detail::command const &                   command,
       boost::shared_ptr <struct state>          state);
 
@@ -118,13 +191,26 @@ protected:
     */
    virtual void
    send_accept (
-      tcp_connection_ptr                        client_connection,
-      detail::command const &                   client_command,
       boost::asio::ip::tcp::endpoint const &    follower_endpoint,
       tcp_connection_ptr                        follower_connection,
       detail::quorum::server_view &             quorum,
       detail::paxos_context &                   global_state,
-      std::string const &                       byte_array,
+      boost::shared_ptr <struct state>          state);
+
+   /*!
+     \brief Received by leader as a response to a 'accept' command that only contained history
+
+     Continues with the next batch of history, or with the actual proposal once the follower
+     has caught up.
+    */
+   virtual void
+   receive_catchup (
+      boost::optional <enum detail::error_code> error,
+      boost::asio::ip::tcp::endpoint const &    follower_endpoint,
+      tcp_connection_ptr                        follower_connection,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state,
+      detail::command const &                   command,
       boost::shared_ptr <struct state>          state);
 
 
@@ -134,21 +220,59 @@ protected:
    virtual void
    receive_accepted (
       boost::optional <enum detail::error_code> error,
-      tcp_connection_ptr                        client_connection,
-      detail::command                           client_command,
       boost::asio::ip::tcp::endpoint const &    follower_endpoint,
       detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state,
       detail::command const &                   command,
       boost::shared_ptr <struct state>          state);
 
    /*!
-     \brief Sends error command back to client
+     \brief Decides the outcome of the 'prepare' phase as soon as a majority has promised
+
+     Used instead of waiting for all followers when configuration::commit_on_majority () is
+     enabled.
+    */
+   void
+   decide_promise_on_majority (
+      boost::asio::ip::tcp::endpoint const &    follower_endpoint,
+      tcp_connection_ptr                        follower_connection,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state,
+      boost::shared_ptr <struct state>          state);
+
+   /*!
+     \brief Replies to the clients as soon as a majority has accepted our proposal
+
+     Used instead of waiting for all followers when configuration::commit_on_majority () is
+     enabled. Followers that reply after the clients have received their response are only
+     validated against that response.
+    */
+   void
+   decide_accepted_on_majority (
+      boost::asio::ip::tcp::endpoint const &    follower_endpoint,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state,
+      boost::shared_ptr <struct state>          state);
+
+   /*!
+     \brief Sends error command back to all clients
     */
    virtual void
    handle_error (
-      enum detail::error_code   error,
-      quorum::server_view const &    quorum,
-      tcp_connection_ptr        client_connection);
+      enum detail::error_code                   error,
+      quorum::server_view const &               quorum,
+      std::vector <client_request> const &      clients);
+
+   /*!
+     \brief Sends the responses of all followers back to the clients
+
+     Every client receives the response for its own proposal id, which must be the same for
+     all followers.
+    */
+   virtual void
+   send_responses (
+      quorum::server_view const &               quorum,
+      boost::shared_ptr <struct state>          state);
 
 
    /*!
@@ -178,10 +302,52 @@ protected:
    proposal_id ();
 
 
+private:
+
+   /*!
+     \brief Deleter of the state objects created by create_state ()
+    */
+   void
+   destroy_state (
+      struct state *                            state);
+
 private:
 
    durable::storage &   storage_;
 
+   /*!
+     \brief Leader side: the proposal ids of all requests currently in progress
+
+     Since proposals can fail out of order, this is not necessarily a contiguous range.
+    */
+   std::set <int64_t>   proposals_in_progress_;
+
+   /*!
+     \brief Leader side: the highest proposal id sent to each follower that has not replied yet
+
+     Tells send_accept () which proposals are already on their way to a follower, so that a
+     follower that missed some proposals can be sent exactly the history it lacks.
+    */
+   std::map <boost::asio::ip::tcp::endpoint, int64_t>   sent_proposal_ids_;
+
+   /*!
+     \brief Set when a proposal has failed while other proposals were still in progress
+    */
+   bool                                         recovering_;
+
+   /*!
+     \brief Requests deferred by defer_request ()
+    */
+   std::vector <boost::function <void ()> >     deferred_requests_;
+
+   /*!
+     \brief Leader side: accepts deferred by send_accept (), along with the proposal id they
+            belong to
+
+     These wait until all proposals before that proposal id have finished.
+    */
+   std::vector <std::pair <int64_t, boost::function <void ()> > >   deferred_accepts_;
+
 };
 
 }; }; }; }; };
@@ -0,0 +1,53 @@
+/*!
+  Copyright (c) 2012, Leon Mergen, all rights reserved.
+ */
+
+#ifndef LIBPAXOS_CPP_DETAIL_STRATEGY_MULTI_PAXOS_FACTORY_HPP
+#define LIBPAXOS_CPP_DETAIL_STRATEGY_MULTI_PAXOS_FACTORY_HPP
+
+#include "../factory.hpp"
+
+namespace paxos { 
+class configuration;
+}; 
+
+namespace paxos { namespace detail { namespace strategy { namespace multi_paxos {
+
+/*!
+  \brief Factory which creates multi-paxos strategies
+
+  \par Examples
+
+  Set up a paxos::server that uses the multi-paxos strategy, which skips the prepare phase
+  for consecutive proposals of a stable leader:
+
+  \code{.cpp}
+
+  paxos::configuration configuration;
+  configuration.set_strategy_factory (
+     new paxos::detail::strategy::multi_paxos::factory (configuration));
+
+  \endcode
+
+  \note All servers inside a quorum must use the same strategy.
+ */
+class factory : public detail::strategy::factory
+{
+public:
+
+   factory (
+      paxos::configuration &    configuration);
+
+   virtual strategy *
+   create () const;
+
+private:
+
+   paxos::configuration &       configuration_;
+
+};
+
+} }; }; };
+
+
+#endif  //! LIBPAXOS_CPP_DETAIL_STRATEGY_MULTI_PAXOS_FACTORY_HPP
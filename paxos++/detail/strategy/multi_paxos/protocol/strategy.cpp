@@ -0,0 +1,237 @@
+#include "../../../quorum/server_view.hpp"
+#include "../../../command.hpp"
+#include "../../../tcp_connection.hpp"
+#include "../../../util/debug.hpp"
+
+#include "strategy.hpp"
+
+namespace paxos { namespace detail { namespace strategy { namespace multi_paxos { namespace protocol {
+
+
+strategy::strategy (
+   durable::storage &   storage)
+   : basic_paxos::protocol::strategy (storage)
+{
+}
+
+/*! virtual */ void
+strategy::initiate (
+   std::vector <client_request> const & clients,
+   detail::quorum::server_view &        quorum,
+   detail::paxos_context &              global_state,
+   queue_guard_type                     queue_guard)
+{
+   std::vector <boost::asio::ip::tcp::endpoint> live_servers = quorum.live_servers ();
+
+   if (this->is_established (quorum, live_servers) == false)
+   {
+      /*!
+        Either we have never been the leader, or something changed within the quorum since
+        the last time all followers promised to us. Run a full 'prepare' round first.
+       */
+      PAXOS_DEBUG ("leadership not established, falling back to prepare round");
+
+      prepared_servers_.clear ();
+
+      basic_paxos::protocol::strategy::initiate (clients,
+                                                 quorum,
+                                                 global_state,
+                                                 queue_guard);
+      return;
+   }
+
+   if (this->defer_request (clients,
+                            quorum,
+                            global_state,
+                            queue_guard) == true)
+   {
+      return;
+   }
+
+   boost::shared_ptr <struct state> state = this->create_state (clients,
+                                                                queue_guard);
+
+   /*!
+     All live servers have already promised to accept our proposals in an earlier round, so
+     we can pretend all of them have just sent us a promise again.
+    */
+   for (boost::asio::ip::tcp::endpoint const & endpoint : live_servers)
+   {
+      detail::quorum::server & server = quorum.lookup_server (endpoint);
+
+      PAXOS_ASSERT (server.has_connection () == true);
+
+      state->connections[endpoint] = server.connection ();
+      state->accepted[endpoint]    = response_ack;
+   }
+
+   for (auto & i : state->connections)
+   {
+      PAXOS_DEBUG ("sending accept-only request to server " << i.first);
+
+      send_accept (i.first,
+                   i.second,
+                   quorum,
+                   global_state,
+                   state);
+   }
+}
+
+
+/*! virtual */ void
+strategy::accept (
+   tcp_connection_ptr                   leader_connection,
+   detail::command const &              command,
+   detail::quorum::server_view &        quorum,
+   detail::paxos_context &              global_state)
+{
+   /*!
+     Note that we do not validate whether the host is still our leader here: as long as we
+     have not promised anything to another leader, our promise still stands. Another leader
+     will always have to go through a 'prepare' round first.
+    */
+   if (promised_leader_.is_initialized () == true
+       && command.host_endpoint () == *promised_leader_)
+   {
+      basic_paxos::protocol::strategy::accept (leader_connection,
+                                               command,
+                                               quorum,
+                                               global_state);
+      return;
+   }
+
+   /*!
+     We have not promised anything to this host, so it has to go through a 'prepare' round
+     first. Note that we do not reply with error_no_leader here, since that would make the
+     client look for another leader, while the leader usually just has to prepare again.
+    */
+   PAXOS_WARN ("received accept from " << command.host_endpoint () << " without a promise");
+
+   this->process_remote_host_information (command,
+                                          quorum);
+
+   detail::command response;
+   response.set_type (command::type_request_fail);
+   response.set_error_code (detail::error_incorrect_proposal);
+
+   this->add_local_host_information (quorum, response);
+
+   leader_connection->write_command (response);
+}
+
+
+/*! virtual */ detail::command
+strategy::process_prepare (
+   detail::command const &              command,
+   detail::quorum::server_view &        quorum)
+{
+   detail::command response =
+      basic_paxos::protocol::strategy::process_prepare (command,
+                                                        quorum);
+
+   if (response.type () == command::type_request_promise)
+   {
+      promised_leader_ = command.host_endpoint ();
+   }
+
+   return response;
+}
+
+
+/*! virtual */ void
+strategy::receive_promise (
+   boost::optional <enum detail::error_code>    error,
+   boost::asio::ip::tcp::endpoint const &       follower_endpoint,
+   tcp_connection_ptr                           follower_connection,
+   detail::quorum::server_view &                quorum,
+   detail::paxos_context &                      global_state,
+   detail::command const &                      command,
+   boost::shared_ptr <struct state>             state)
+{
+   basic_paxos::protocol::strategy::receive_promise (error,
+                                                     follower_endpoint,
+                                                     follower_connection,
+                                                     quorum,
+                                                     global_state,
+                                                     command,
+                                                     state);
+
+   if (state->connections.size () != state->accepted.size ())
+   {
+      return;
+   }
+
+   prepared_servers_.clear ();
+
+   for (auto const & i : state->accepted)
+   {
+      if (i.second != response_ack)
+      {
+         prepared_servers_.clear ();
+         return;
+      }
+
+      prepared_servers_.push_back (i.first);
+   }
+
+   PAXOS_DEBUG ("leadership established with " << prepared_servers_.size () << " servers");
+}
+
+
+/*! virtual */ void
+strategy::receive_accepted (
+   boost::optional <enum detail::error_code>    error,
+   boost::asio::ip::tcp::endpoint const &       follower_endpoint,
+   detail::quorum::server_view &                quorum,
+   detail::paxos_context &                      global_state,
+   detail::command const &                      command,
+   boost::shared_ptr <struct state>             state)
+{
+   if (error || command.type () != command::type_request_accepted)
+   {
+      prepared_servers_.clear ();
+   }
+
+   basic_paxos::protocol::strategy::receive_accepted (error,
+                                                      follower_endpoint,
+                                                      quorum,
+                                                      global_state,
+                                                      command,
+                                                      state);
+}
+
+
+/*! virtual */ void
+strategy::handle_error (
+   enum detail::error_code              error,
+   quorum::server_view const &          quorum,
+   std::vector <client_request> const & clients)
+{
+   prepared_servers_.clear ();
+
+   basic_paxos::protocol::strategy::handle_error (error,
+                                                  quorum,
+                                                  clients);
+}
+
+
+bool
+strategy::is_established (
+   detail::quorum::server_view &                                quorum,
+   std::vector <boost::asio::ip::tcp::endpoint> const &         live_servers)
+{
+   if (prepared_servers_.empty () == true
+       || live_servers != prepared_servers_
+       || quorum.has_majority () == false)
+   {
+      return false;
+   }
+
+   boost::optional <boost::asio::ip::tcp::endpoint> leader = quorum.who_is_our_leader ();
+
+   return
+      leader.is_initialized () == true
+      && *leader == quorum.our_endpoint ();
+}
+
+}; }; }; }; };
@@ -0,0 +1,137 @@
+/*!
+  Copyright (c) 2012, Leon Mergen, all rights reserved.
+ */
+
+#ifndef LIBPAXOS_CPP_DETAIL_STRATEGY_MULTI_PAXOS_PROTOCOL_STRATEGY_HPP
+#define LIBPAXOS_CPP_DETAIL_STRATEGY_MULTI_PAXOS_PROTOCOL_STRATEGY_HPP
+
+#include <vector>
+
+#include <boost/optional.hpp>
+#include <boost/asio/ip/tcp.hpp>
+
+#include "../../basic_paxos/protocol/strategy.hpp"
+
+namespace paxos { namespace detail { namespace strategy { namespace multi_paxos { namespace protocol {
+
+/*!
+  \brief Multi-paxos protocol, which lets a stable leader skip the prepare phase
+
+  The basic paxos protocol requires two full round-trips to every follower for every proposal:
+  one 'prepare' round and one 'accept' round. When the leader does not change between
+  consecutive proposals, the 'prepare' round does not provide any new information: the followers
+  already promised to accept proposals from this leader.
+
+  This strategy runs a regular 'prepare' round once, after which it streams 'accept'-only rounds
+  for all consecutive proposals. As soon as anything changes within the quorum (the leader changes,
+  a server dies or comes alive, or a follower rejects a proposal) the leader falls back to a full
+  'prepare' round again.
+
+  The followers keep track of the leader they have promised to; an 'accept' command from any other
+  host is rejected.
+ */
+class strategy : public detail::strategy::basic_paxos::protocol::strategy
+{
+public:
+
+   strategy (
+      durable::storage &        storage);
+
+   /*!
+     \brief Received by leader from one or more clients that initiate a request
+    */
+   virtual void
+   initiate (
+      std::vector <client_request> const &      clients,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state,
+      queue_guard_type                          queue_guard);
+
+   /*!
+     \brief Received by follower when leader wants to process a request
+
+     Rejects the request when it is not coming from the leader we have promised to.
+    */
+   virtual void
+   accept (
+      tcp_connection_ptr                        leader_connection,
+      detail::command const &                   command,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state);
+
+protected:
+
+   /*!
+     \brief Validates a 'prepare' command, and remembers the leader we promised to
+    */
+   virtual detail::command
+   process_prepare (
+      detail::command const &                   command,
+      detail::quorum::server_view &             quorum);
+
+   /*!
+     \brief Received by leader as a response to a 'prepare' command
+
+     Marks our leadership as established when all followers have promised.
+    */
+   virtual void
+   receive_promise (
+      boost::optional <enum detail::error_code> error,
+      boost::asio::ip::tcp::endpoint const &    follower_endpoint,
+      tcp_connection_ptr                        follower_connection,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state,
+      detail::command const &                   command,
+      boost::shared_ptr <struct state>          state);
+
+   /*!
+     \brief Received by leader as a response to a 'accept' command
+
+     Drops our leadership when a follower did not accept our proposal.
+    */
+   virtual void
+   receive_accepted (
+      boost::optional <enum detail::error_code> error,
+      boost::asio::ip::tcp::endpoint const &    follower_endpoint,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state,
+      detail::command const &                   command,
+      boost::shared_ptr <struct state>          state);
+
+   /*!
+     \brief Sends error command back to all clients, and drops our leadership
+    */
+   virtual void
+   handle_error (
+      enum detail::error_code                   error,
+      quorum::server_view const &               quorum,
+      std::vector <client_request> const &      clients);
+
+private:
+
+   /*!
+     \brief Returns true if we can skip the 'prepare' phase for a new proposal
+    */
+   bool
+   is_established (
+      detail::quorum::server_view &                             quorum,
+      std::vector <boost::asio::ip::tcp::endpoint> const &      live_servers);
+
+private:
+
+   /*!
+     \brief Leader side: the servers that promised to accept our proposals, if any
+
+     This is empty when our leadership has not been established (yet).
+    */
+   std::vector <boost::asio::ip::tcp::endpoint>         prepared_servers_;
+
+   /*!
+     \brief Follower side: the leader we have most recently promised to
+    */
+   boost::optional <boost::asio::ip::tcp::endpoint>     promised_leader_;
+};
+
+}; }; }; }; };
+
+#endif //! LIBPAXOS_CPP_DETAIL_STRATEGY_MULTI_PAXOS_PROTOCOL_STRATEGY_HPP
@@ -5,6 +5,8 @@
 #ifndef LIBPAXOS_CPP_DETAIL_STRATEGY_REQUEST_HPP
 #define LIBPAXOS_CPP_DETAIL_STRATEGY_REQUEST_HPP
 
+#include <vector>
+
 #include "../command.hpp"
 #include "../tcp_connection_fwd.hpp"
 
@@ -19,12 +21,23 @@ class server_view;
 namespace paxos { namespace detail { namespace strategy {
 
 /*!
-  \brief Keeps track of context information required by the various Paxos protocol implementations
+  \brief A single workload a client wants to have processed by the quorum
  */
-struct request
+struct client_request
 {
    detail::tcp_connection_ptr    connection_;
    detail::command               command_;
+};
+
+/*!
+  \brief Keeps track of context information required by the various Paxos protocol implementations
+
+  A request usually holds a single client's workload, but the leader can merge the workloads of
+  multiple clients into a single request, see configuration::set_batch_max_entries ().
+ */
+struct request
+{
+   std::vector <client_request>  clients_;
    detail::quorum::server_view & quorum_;
    detail::paxos_context &       global_state_;
 };
@@ -35,15 +35,14 @@ public:
    virtual ~strategy ();
 
    /*!
-     \brief Received by leader from client that initiates a request
+     \brief Received by leader from one or more clients that initiate a request
     */
    virtual void
    initiate (      
-      tcp_connection_ptr                client_connection,
-      detail::command const &           command,
-      detail::quorum::server_view &     quorum,
-      detail::paxos_context &           global_state,
-      queue_guard_type                  queue_guard) = 0;
+      std::vector <client_request> const &      clients,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state,
+      queue_guard_type                          queue_guard) = 0;
 
 
    /*!
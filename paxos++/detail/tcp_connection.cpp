@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 #include <functional>
 
@@ -16,7 +17,13 @@ namespace paxos { namespace detail {
 
 tcp_connection::tcp_connection (
    boost::asio::io_service &                    io_service)
-   : socket_ (io_service)
+   : io_service_ (io_service),
+     socket_ (io_service),
+     write_in_progress_ (0),
+     queued_bytes_ (0),
+     max_queued_bytes_ (0),
+     read_buffer_begin_ (0),
+     read_buffer_end_ (0)
 {
 }
 
@@ -66,8 +73,198 @@ void
 tcp_connection::read_command (
    read_callback        callback)
 {
-   parser::read_command (shared_from_this (),
-                         callback);
+   boost::mutex::scoped_lock lock (read_mutex_);
+
+   boost::shared_ptr <std::queue <read_callback> > callbacks = read_callbacks_.lock ();
+
+   if (callbacks)
+   {
+      /*!
+        Another read is already in progress, the callback will be picked up by
+        handle_read () as soon as the commands before it have been read.
+       */
+      callbacks->push (callback);
+      return;
+   }
+
+   callbacks.reset (new std::queue <read_callback> ());
+   callbacks->push (callback);
+
+   read_callbacks_ = callbacks;
+
+   start_read_locked (callbacks);
+}
+
+void
+tcp_connection::start_read_locked (
+   boost::shared_ptr <std::queue <read_callback> >      callbacks)
+{
+   PAXOS_ASSERT (callbacks->empty () == false);
+
+   boost::optional <size_t> frame_size =
+      parser::frame_size (read_buffer_.data () + read_buffer_begin_,
+                          read_buffer_end_ - read_buffer_begin_);
+
+   if (frame_size.is_initialized () == true
+       && *frame_size <= read_buffer_end_ - read_buffer_begin_)
+   {
+      /*!
+        An earlier read already received the next command. We cannot invoke the callback
+        from here since we are holding the lock, and our caller is likely a read callback
+        itself, so let the io_service dispatch it instead.
+       */
+      io_service_.post (std::bind (&tcp_connection::process_read_buffer,
+                                   shared_from_this (),
+                                   callbacks));
+      return;
+   }
+
+   /*!
+     Move the partially received command to the front of the buffer, so that we have as much
+     room as possible to receive the rest of the data in.
+    */
+   if (read_buffer_begin_ > 0)
+   {
+      std::copy (read_buffer_.begin () + read_buffer_begin_,
+                 read_buffer_.begin () + read_buffer_end_,
+                 read_buffer_.begin ());
+
+      read_buffer_end_   -= read_buffer_begin_;
+      read_buffer_begin_  = 0;
+   }
+
+   size_t const minimum_size = 64 * 1024;
+   size_t       required     = std::max (read_buffer_end_ + minimum_size / 4,
+                                         frame_size.get_value_or (0));
+
+   if (read_buffer_.size () < required)
+   {
+      read_buffer_.resize (std::max (required, minimum_size));
+   }
+
+   socket_.async_read_some (
+      boost::asio::buffer (read_buffer_.data () + read_buffer_end_,
+                           read_buffer_.size () - read_buffer_end_),
+      std::bind (&tcp_connection::handle_receive,
+                 shared_from_this (),
+                 callbacks,
+                 std::placeholders::_1,
+                 std::placeholders::_2));
+}
+
+void
+tcp_connection::handle_receive (
+   boost::shared_ptr <std::queue <read_callback> >      callbacks,
+   boost::system::error_code const &                    error,
+   size_t                                               bytes_transferred)
+{
+   if (error)
+   {
+      std::queue <read_callback> failed;
+
+      {
+         boost::mutex::scoped_lock lock (read_mutex_);
+
+         /*!
+           No more commands will arrive on this connection, so all pending reads fail.
+          */
+         std::swap (failed, *callbacks);
+         read_callbacks_.reset ();
+      }
+
+      while (failed.empty () == false)
+      {
+         failed.front () (detail::error_connection_close,
+                          command ());
+         failed.pop ();
+      }
+
+      return;
+   }
+
+   {
+      boost::mutex::scoped_lock lock (read_mutex_);
+      read_buffer_end_ += bytes_transferred;
+
+      PAXOS_ASSERT (read_buffer_end_ <= read_buffer_.size ());
+   }
+
+   process_read_buffer (callbacks);
+}
+
+void
+tcp_connection::process_read_buffer (
+   boost::shared_ptr <std::queue <read_callback> >      callbacks)
+{
+   std::vector <std::pair <read_callback, command> >    ready;
+   std::queue <read_callback>                           failed;
+
+   {
+      boost::mutex::scoped_lock lock (read_mutex_);
+      PAXOS_ASSERT (callbacks->empty () == false);
+
+      while (callbacks->empty () == false)
+      {
+         char const *   data = read_buffer_.data () + read_buffer_begin_;
+         size_t         size = read_buffer_end_ - read_buffer_begin_;
+
+         boost::optional <size_t> frame_size = parser::frame_size (data, size);
+
+         if (frame_size.is_initialized () == false
+             || *frame_size > size)
+         {
+            break;
+         }
+
+         boost::optional <command> command = parser::parse_command (data,
+                                                                    *frame_size);
+         read_buffer_begin_ += *frame_size;
+
+         if (command.is_initialized () == false)
+         {
+            /*!
+              We cannot tell where the next command starts, so there is no way to recover
+              from this.
+             */
+            PAXOS_WARN ("unable to decode command from connection = " << this);
+
+            std::swap (failed, *callbacks);
+            socket_.close ();
+            break;
+         }
+
+         ready.push_back (std::make_pair (callbacks->front (),
+                                          std::move (*command)));
+         callbacks->pop ();
+      }
+
+      if (read_buffer_begin_ == read_buffer_end_)
+      {
+         read_buffer_begin_ = read_buffer_end_ = 0;
+      }
+
+      if (callbacks->empty () == true)
+      {
+         read_callbacks_.reset ();
+      }
+      else
+      {
+         start_read_locked (callbacks);
+      }
+   }
+
+   for (auto const & i : ready)
+   {
+      i.first (boost::none,
+               i.second);
+   }
+
+   while (failed.empty () == false)
+   {
+      failed.front () (detail::error_protocol_mismatch,
+                       command ());
+      failed.pop ();
+   }
 }
 
 void
@@ -94,49 +291,74 @@ tcp_connection::read_command_loop (
 
 
 
-void
-tcp_connection::write (
-   std::string const &  message)
+size_t
+tcp_connection::queued_bytes () const
+{
+   boost::mutex::scoped_lock lock (mutex_);
+   return queued_bytes_;
+}
+
+size_t
+tcp_connection::max_queued_bytes () const
 {
    boost::mutex::scoped_lock lock (mutex_);
-   write_locked (message);
+   return max_queued_bytes_;
 }
 
+
 void
-tcp_connection::write_locked (
-   std::string const &  message)
+tcp_connection::write (
+   boost::shared_ptr <std::string const>        message)
 {
+   boost::mutex::scoped_lock lock (mutex_);
+
    /*!
-     The problem with Boost.Asio is that it assumes that the buffer we send to async_write ()
-     must stay alive until the callback to handle_write () has been called. Since there is no
-     way we can guarantee that if we use the message object we get as a reference to this function,
-     we have no alternative but to copy the data into our local buffer.
-
-     But wait! What happends when write() is called when we are not yet done writing another
-     block? In that case, we will just append that data onto the queue. The handle_write () function
-     checks whether any data is still pending on the queue, and if so, ensures another async_write ()
-     is called.
+     Boost.Asio requires that the data we pass to async_write () stays alive until handle_write ()
+     has been called, and it doesn't allow us to do multiple async_write () calls at the same time.
+
+     So, we keep all messages on a queue. When no write is in progress, we start one; otherwise
+     handle_write () will pick up the message as soon as the current write has completed.
     */
+   write_queue_.push_back (message);
 
-   if (write_buffer_.empty () == true)
-   {
-      write_buffer_ = message;
+   queued_bytes_     += message->size ();
+   max_queued_bytes_  = std::max (max_queued_bytes_, queued_bytes_);
 
-      start_write_locked ();
-   }
-   else
+   if (write_in_progress_ == 0)
    {
-      write_buffer_ += message;
+      start_write_locked ();
    }
 }
 
 void
 tcp_connection::start_write_locked ()
 {
-   PAXOS_ASSERT (write_buffer_.empty () == false);
+   PAXOS_ASSERT_EQ (write_in_progress_, 0);
+   PAXOS_ASSERT (write_queue_.empty () == false);
+
+   /*!
+     Write all queued messages in a single system call, while still limiting the amount of
+     buffers we hand over to the OS at once.
+    */
+   size_t const max_buffers = 64;
+
+   std::vector <boost::asio::const_buffer> buffers;
+   buffers.reserve (std::min (write_queue_.size (), max_buffers));
+
+   for (boost::shared_ptr <std::string const> const & message : write_queue_)
+   {
+      if (buffers.size () == max_buffers)
+      {
+         break;
+      }
+
+      buffers.push_back (boost::asio::buffer (*message));
+   }
+
+   write_in_progress_ = buffers.size ();
 
    boost::asio::async_write (socket_,
-                             boost::asio::buffer (write_buffer_),
+                             buffers,
                              std::bind (&tcp_connection::handle_write, 
 
                                         /*!
@@ -147,38 +369,44 @@ tcp_connection::start_write_locked ()
                                         */
                                         shared_from_this(),
                                         std::placeholders::_1,
-                                        std::placeholders::_2));
+                                        write_in_progress_));
 }
 
 void
 tcp_connection::handle_write (
    boost::system::error_code const &    error,
-   size_t                               bytes_transferred)
+   size_t                               frames)
 {
+   boost::mutex::scoped_lock lock (mutex_);
+
+   PAXOS_ASSERT_EQ (write_in_progress_, frames);
+   PAXOS_ASSERT (write_queue_.size () >= frames);
+
+   write_in_progress_ = 0;
+
    if (error)
    {
       PAXOS_WARN ("an error occured while writing data: " << error.message ());
+
+      /*!
+        None of the queued messages will ever arrive at the other side.
+       */
+      write_queue_.clear ();
+      queued_bytes_ = 0;
       return;
    }
 
-   boost::mutex::scoped_lock lock (mutex_);
-   handle_write_locked (bytes_transferred);
-}
-
-
-void
-tcp_connection::handle_write_locked (
-   size_t                               bytes_transferred)
-{
-   PAXOS_ASSERT (write_buffer_.size () >= bytes_transferred);
-
-   write_buffer_ = write_buffer_.substr (bytes_transferred);
+   for (size_t i = 0; i < frames; ++i)
+   {
+      queued_bytes_ -= write_queue_.front ()->size ();
+      write_queue_.pop_front ();
+   }
 
    /*!
-     As discussed in the write () function, if we still have data on the buffer, ensure
-     that data is also written.
+     As discussed in the write () function, if more messages have been queued in the meantime,
+     ensure those are also written.
     */
-   if (write_buffer_.empty () == false)
+   if (write_queue_.empty () == false)
    {
       start_write_locked ();
    }
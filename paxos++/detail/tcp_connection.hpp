@@ -5,12 +5,15 @@
 #ifndef LIBPAXOS_CPP_DETAIL_TCP_CONNECTION_HPP
 #define LIBPAXOS_CPP_DETAIL_TCP_CONNECTION_HPP
 
+#include <deque>
+#include <queue>
 #include <vector>
 
 #include <boost/function.hpp>
 #include <boost/optional.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/thread/mutex.hpp>
 
@@ -83,11 +86,33 @@ public:
 
    /*!
      \brief Reads a command from the other side
+
+     This function can be called again before the callback of an earlier call has been
+     invoked: the callbacks are invoked in the same order as the commands are received. This
+     allows the leader to have multiple proposals in progress on the same connection.
+
+     Data is received in as large chunks as the socket allows, and all commands that are
+     contained in a single chunk are decoded directly from the receive buffer.
     */
    void
    read_command (
       read_callback             callback);
 
+   /*!
+     \brief Amount of bytes that are waiting to be written to the other side
+
+     This includes the data that is currently being written. A number that keeps growing
+     means the other side cannot keep up with us.
+    */
+   size_t
+   queued_bytes () const;
+
+   /*!
+     \brief Highest amount of bytes that have been waiting to be written at the same time
+    */
+   size_t
+   max_queued_bytes () const;
+
    /*!
      \brief Keeps reading commands  until connection error occurs
 
@@ -104,13 +129,30 @@ private:
    tcp_connection (
       boost::asio::io_service &                 io_service);
 
+   /*!
+     \brief Ensures the first callback in \c callbacks is invoked as soon as a command is available
+     \pre callbacks->empty () == false
+    */
+   void
+   start_read_locked (
+      boost::shared_ptr <std::queue <read_callback> >   callbacks);
+
    void
-   write (
-      std::string const &       message);
+   handle_receive (
+      boost::shared_ptr <std::queue <read_callback> >   callbacks,
+      boost::system::error_code const &                 error,
+      size_t                                            bytes_transferred);
+
+   /*!
+     \brief Dispatches all complete commands in our receive buffer to the waiting callbacks
+    */
+   void
+   process_read_buffer (
+      boost::shared_ptr <std::queue <read_callback> >   callbacks);
 
    void
-   write_locked (
-      std::string const &       message);
+   write (
+      boost::shared_ptr <std::string const>     message);
 
    void
    start_write_locked ();
@@ -118,22 +160,57 @@ private:
    void
    handle_write (
       boost::system::error_code const & error,
-      size_t                            bytes_transferred);
-
-   void
-   handle_write_locked (
-      size_t                            bytes_transferred);
+      size_t                            frames);
 
 private:
 
+   boost::asio::io_service &    io_service_;
    boost::asio::ip::tcp::socket socket_;
 
    /*!
-     \brief Synchronizes access to write_buffer_
+     \brief Synchronizes access to the write queue
+    */
+   mutable boost::mutex         mutex_;
+
+   /*!
+     \brief Messages waiting to be written, in order
+
+     The messages are never modified once they are queued, so the messages that are being
+     written can be passed to Boost.Asio as-is while new messages are added to the queue.
+    */
+   std::deque <boost::shared_ptr <std::string const> >  write_queue_;
+
+   /*!
+     \brief Amount of messages at the front of write_queue_ that are currently being written
     */
-   boost::mutex                 mutex_;
+   size_t                       write_in_progress_;
 
-   std::string                  write_buffer_;
+   size_t                       queued_bytes_;
+   size_t                       max_queued_bytes_;
+
+   /*!
+     \brief Synchronizes access to read_callbacks_ and the read buffer
+    */
+   boost::mutex                 read_mutex_;
+
+   /*!
+     \brief Data received from the other side that has not been dispatched yet
+
+     Only the range [read_buffer_begin_, read_buffer_end_) contains valid data. The buffer is
+     reused for all reads on this connection, and only grows when a single command does not
+     fit in it.
+    */
+   std::vector <char>           read_buffer_;
+   size_t                       read_buffer_begin_;
+   size_t                       read_buffer_end_;
+
+   /*!
+     \brief Callbacks waiting for a command to be read, in the order they were registered
+
+     The callbacks usually hold a reference to this connection. To prevent a cyclic reference,
+     the queue is owned by the read operation in progress, and we only keep a weak reference.
+    */
+   boost::weak_ptr <std::queue <read_callback> >        read_callbacks_;
 };
 
 }; };
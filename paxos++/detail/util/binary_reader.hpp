@@ -0,0 +1,78 @@
+/*!
+  Copyright (c) 2012, Leon Mergen, all rights reserved.
+ */
+
+#ifndef LIBPAXOS_CPP_DETAIL_UTIL_BINARY_READER_HPP
+#define LIBPAXOS_CPP_DETAIL_UTIL_BINARY_READER_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+namespace paxos { namespace detail { namespace util {
+
+/*!
+  \brief Reads values encoded by binary_writer directly from a byte buffer
+
+  The buffer is not copied, so it must remain valid for as long as the reader is used. All
+  read functions return false when the buffer does not contain enough data, in which case
+  the output value is left in an undefined state.
+ */
+class binary_reader
+{
+public:
+
+   binary_reader (
+      char const *      data,
+      size_t            size);
+
+   bool
+   read_byte (
+      uint8_t &         value);
+
+   bool
+   read_uint16 (
+      uint16_t &        value);
+
+   bool
+   read_uint32 (
+      uint32_t &        value);
+
+   bool
+   read_uint64 (
+      uint64_t &        value);
+
+   bool
+   read_varint (
+      uint64_t &        value);
+
+   bool
+   read_signed_varint (
+      int64_t &         value);
+
+   bool
+   read_bytes (
+      void *            data,
+      size_t            size);
+
+   bool
+   read_string (
+      std::string &     value);
+
+   /*!
+     \brief Returns true if all data has been read
+    */
+   bool
+   at_end () const;
+
+private:
+
+   char const *         position_;
+   char const *         end_;
+};
+
+}; }; };
+
+#include "binary_reader.inl"
+
+#endif //! LIBPAXOS_CPP_DETAIL_UTIL_BINARY_READER_HPP
@@ -0,0 +1,161 @@
+#include <string.h>
+
+namespace paxos { namespace detail { namespace util {
+
+inline binary_reader::binary_reader (
+   char const * data,
+   size_t       size)
+   : position_ (data),
+     end_ (data + size)
+{
+}
+
+inline bool
+binary_reader::read_byte (
+   uint8_t &    value)
+{
+   if (position_ == end_)
+   {
+      return false;
+   }
+
+   value = static_cast <uint8_t> (*position_++);
+   return true;
+}
+
+inline bool
+binary_reader::read_uint16 (
+   uint16_t &   value)
+{
+   uint8_t high;
+   uint8_t low;
+
+   if (read_byte (high) == false
+       || read_byte (low) == false)
+   {
+      return false;
+   }
+
+   value = static_cast <uint16_t> ((high << 8) | low);
+   return true;
+}
+
+inline bool
+binary_reader::read_uint32 (
+   uint32_t &   value)
+{
+   uint16_t high;
+   uint16_t low;
+
+   if (read_uint16 (high) == false
+       || read_uint16 (low) == false)
+   {
+      return false;
+   }
+
+   value = (static_cast <uint32_t> (high) << 16) | low;
+   return true;
+}
+
+inline bool
+binary_reader::read_uint64 (
+   uint64_t &   value)
+{
+   uint32_t high;
+   uint32_t low;
+
+   if (read_uint32 (high) == false
+       || read_uint32 (low) == false)
+   {
+      return false;
+   }
+
+   value = (static_cast <uint64_t> (high) << 32) | low;
+   return true;
+}
+
+inline bool
+binary_reader::read_varint (
+   uint64_t &   value)
+{
+   value = 0;
+
+   for (unsigned int shift = 0; shift < 64; shift += 7)
+   {
+      uint8_t byte;
+
+      if (read_byte (byte) == false)
+      {
+         return false;
+      }
+
+      value |= static_cast <uint64_t> (byte & 0x7f) << shift;
+
+      if ((byte & 0x80) == 0)
+      {
+         return true;
+      }
+   }
+
+   /*!
+     More than 10 bytes means this is not a valid varint.
+    */
+   return false;
+}
+
+inline bool
+binary_reader::read_signed_varint (
+   int64_t &    value)
+{
+   uint64_t encoded;
+
+   if (read_varint (encoded) == false)
+   {
+      return false;
+   }
+
+   value = static_cast <int64_t> (encoded >> 1) ^ -static_cast <int64_t> (encoded & 1);
+   return true;
+}
+
+inline bool
+binary_reader::read_bytes (
+   void *       data,
+   size_t       size)
+{
+   if (static_cast <size_t> (end_ - position_) < size)
+   {
+      return false;
+   }
+
+   memcpy (data, position_, size);
+   position_ += size;
+
+   return true;
+}
+
+inline bool
+binary_reader::read_string (
+   std::string &        value)
+{
+   uint64_t size;
+
+   if (read_varint (size) == false
+       || static_cast <uint64_t> (end_ - position_) < size)
+   {
+      return false;
+   }
+
+   value.assign (position_, size);
+   position_ += size;
+
+   return true;
+}
+
+inline bool
+binary_reader::at_end () const
+{
+   return position_ == end_;
+}
+
+}; }; };
@@ -0,0 +1,89 @@
+/*!
+  Copyright (c) 2012, Leon Mergen, all rights reserved.
+ */
+
+#ifndef LIBPAXOS_CPP_DETAIL_UTIL_BINARY_WRITER_HPP
+#define LIBPAXOS_CPP_DETAIL_UTIL_BINARY_WRITER_HPP
+
+#include <stdint.h>
+#include <string>
+
+namespace paxos { namespace detail { namespace util {
+
+/*!
+  \brief Appends binary encoded values to a byte array
+
+  Integers that are usually small (such as proposal ids and lengths) are encoded as variable
+  length integers, which take up one byte for every 7 bits of the value. Signed integers are
+  zigzag encoded first, so that small negative values are small as well.
+
+  This is used for the wire format of commands; see binary_reader for the inverse operation.
+ */
+class binary_writer
+{
+public:
+
+   /*!
+     \param buffer Byte array to append all values to
+    */
+   binary_writer (
+      std::string &     buffer);
+
+   void
+   write_byte (
+      uint8_t           value);
+
+   /*!
+     \brief Writes a fixed size, big-endian 16 bit integer
+    */
+   void
+   write_uint16 (
+      uint16_t          value);
+
+   /*!
+     \brief Writes a fixed size, big-endian 32 bit integer
+    */
+   void
+   write_uint32 (
+      uint32_t          value);
+
+   /*!
+     \brief Writes a fixed size, big-endian 64 bit integer
+    */
+   void
+   write_uint64 (
+      uint64_t          value);
+
+   void
+   write_varint (
+      uint64_t          value);
+
+   void
+   write_signed_varint (
+      int64_t           value);
+
+   /*!
+     \brief Writes raw bytes, without any length information
+    */
+   void
+   write_bytes (
+      void const *      data,
+      size_t            size);
+
+   /*!
+     \brief Writes a length-prefixed byte array
+    */
+   void
+   write_string (
+      std::string const &       value);
+
+private:
+
+   std::string &        buffer_;
+};
+
+}; }; };
+
+#include "binary_writer.inl"
+
+#endif //! LIBPAXOS_CPP_DETAIL_UTIL_BINARY_WRITER_HPP
@@ -0,0 +1,79 @@
+namespace paxos { namespace detail { namespace util {
+
+inline binary_writer::binary_writer (
+   std::string &        buffer)
+   : buffer_ (buffer)
+{
+}
+
+inline void
+binary_writer::write_byte (
+   uint8_t      value)
+{
+   buffer_ += static_cast <char> (value);
+}
+
+inline void
+binary_writer::write_uint16 (
+   uint16_t     value)
+{
+   write_byte (static_cast <uint8_t> (value >> 8));
+   write_byte (static_cast <uint8_t> (value & 0xff));
+}
+
+inline void
+binary_writer::write_uint32 (
+   uint32_t     value)
+{
+   write_uint16 (static_cast <uint16_t> (value >> 16));
+   write_uint16 (static_cast <uint16_t> (value & 0xffff));
+}
+
+inline void
+binary_writer::write_uint64 (
+   uint64_t     value)
+{
+   write_uint32 (static_cast <uint32_t> (value >> 32));
+   write_uint32 (static_cast <uint32_t> (value & 0xffffffff));
+}
+
+inline void
+binary_writer::write_varint (
+   uint64_t     value)
+{
+   /*!
+     The high bit of every byte tells whether more bytes follow.
+    */
+   while (value >= 0x80)
+   {
+      write_byte (static_cast <uint8_t> (value & 0x7f) | 0x80);
+      value >>= 7;
+   }
+
+   write_byte (static_cast <uint8_t> (value));
+}
+
+inline void
+binary_writer::write_signed_varint (
+   int64_t      value)
+{
+   write_varint ((static_cast <uint64_t> (value) << 1) ^ static_cast <uint64_t> (value >> 63));
+}
+
+inline void
+binary_writer::write_bytes (
+   void const * data,
+   size_t       size)
+{
+   buffer_.append (static_cast <char const *> (data), size);
+}
+
+inline void
+binary_writer::write_string (
+   std::string const &  value)
+{
+   write_varint (value.size ());
+   buffer_.append (value);
+}
+
+}; }; };
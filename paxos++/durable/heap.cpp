@@ -6,18 +6,27 @@ namespace paxos { namespace durable {
 
 
 /*! virtual */ std::map <int64_t, std::string>
-heap::retrieve (
-   int64_t      proposal_id)
+heap::load_history (
+   int64_t      proposal_id,
+   size_t       max_entries,
+   size_t       max_bytes)
 {
    std::map <int64_t, std::string> result;
+   size_t                          bytes = 0;
 
-   result.insert (data_.find (proposal_id + 1), data_.end ());
+   for (auto i = data_.find (proposal_id + 1);
+        i != data_.end () && result.size () < max_entries && bytes < max_bytes;
+        ++i)
+   {
+      result.insert (result.end (), *i);
+      bytes += i->second.size ();
+   }
 
    return result;
 }
 
 /*! virtual */ int64_t
-heap::highest_proposal_id ()
+heap::load_highest_proposal_id ()
 {
    if (data_.empty () == true)
    {
@@ -30,7 +39,7 @@ heap::highest_proposal_id ()
 }
 
 /*! virtual */ int64_t
-heap::lowest_proposal_id ()
+heap::load_lowest_proposal_id ()
 {
    if (data_.empty () == true)
    {
@@ -76,7 +85,7 @@ heap::remove (
                 data_.find (proposal_id));
    data_.erase (proposal_id);
 
-   PAXOS_ASSERT_EQ (lowest_proposal_id (), proposal_id + 1);
+   PAXOS_ASSERT_EQ (load_lowest_proposal_id (), proposal_id + 1);
 
 }
 
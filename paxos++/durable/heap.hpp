@@ -25,21 +25,19 @@ namespace paxos { namespace durable {
  */
 class heap : public storage
 {
-public:
-
-public:
+protected:
 
    virtual std::map <int64_t, std::string>
-   retrieve (
-      int64_t                   proposal_id);
+   load_history (
+      int64_t                   proposal_id,
+      size_t                    max_entries,
+      size_t                    max_bytes);
 
    virtual int64_t
-   highest_proposal_id ();
+   load_highest_proposal_id ();
 
    virtual int64_t
-   lowest_proposal_id ();
-
-protected:
+   load_lowest_proposal_id ();
 
 
    virtual void
@@ -0,0 +1,477 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+
+#include <boost/crc.hpp>
+
+#include "../exception/exception.hpp"
+#include "../detail/util/binary_reader.hpp"
+#include "../detail/util/binary_writer.hpp"
+#include "../detail/util/debug.hpp"
+
+#include "segmented_log.hpp"
+
+namespace paxos { namespace durable {
+
+/*! static */ size_t const segmented_log::header_size;
+/*! static */ size_t const segmented_log::index_interval;
+
+segmented_log::segmented_log (
+   std::string const &          directory,
+   size_t                       segment_size,
+   bool                         sync)
+   : directory_ (directory),
+     segment_size_ (segment_size),
+     sync_ (sync)
+{
+   PAXOS_ASSERT_GT (segment_size, 0);
+
+   PAXOS_INFO (this << " segmented_log constructor, directory = " << directory);
+
+   PAXOS_CHECK_THROW (
+      mkdir (directory.c_str (), 0755) != 0 && errno != EEXIST,
+      exception::storage_error ());
+
+   this->open_segments ();
+}
+
+/*! virtual */ segmented_log::~segmented_log ()
+{
+   PAXOS_INFO ("shutting down segmented_log backend");
+
+   for (auto & i : segments_)
+   {
+      if (i.second.mapping != NULL)
+      {
+         munmap (const_cast <char *> (i.second.mapping), i.second.mapping_size);
+      }
+
+      close (i.second.file);
+   }
+}
+
+/*! virtual */ std::map <int64_t, std::string>
+segmented_log::load_history (
+   int64_t      proposal_id,
+   size_t       max_entries,
+   size_t       max_bytes)
+{
+   std::map <int64_t, std::string> result;
+   size_t                          bytes = 0;
+
+   /*!
+     Look up the segment that contains the first proposal we are interested in; if that is
+     older than our history, we just start at the beginning.
+    */
+   auto i = segments_.upper_bound (proposal_id + 1);
+   if (i != segments_.begin ())
+   {
+      --i;
+   }
+
+   for (; i != segments_.end () && result.size () < max_entries && bytes < max_bytes; ++i)
+   {
+      struct segment & segment = i->second;
+
+      if (segment.last_proposal_id <= proposal_id)
+      {
+         continue;
+      }
+
+      this->map_segment (segment);
+
+      size_t offset = 0;
+
+      if (proposal_id >= segment.first_proposal_id)
+      {
+         size_t record = proposal_id + 1 - segment.first_proposal_id;
+         offset        = segment.index[record / index_interval];
+      }
+
+      while (offset < segment.size
+             && result.size () < max_entries
+             && bytes < max_bytes)
+      {
+         int64_t        id;
+         char const *   byte_array;
+         size_t         byte_array_size;
+
+         size_t record_size = read_record (segment.mapping + offset,
+                                           segment.size - offset,
+                                           id,
+                                           byte_array,
+                                           byte_array_size);
+
+         PAXOS_ASSERT_GT (record_size, 0);
+
+         if (id > proposal_id)
+         {
+            result[id].assign (byte_array, byte_array_size);
+            bytes += byte_array_size;
+         }
+
+         offset += record_size;
+      }
+   }
+
+   return result;
+}
+
+/*! virtual */ int64_t
+segmented_log::load_highest_proposal_id ()
+{
+   if (segments_.empty () == true)
+   {
+      return 0;
+   }
+
+   return segments_.rbegin ()->second.last_proposal_id;
+}
+
+/*! virtual */ int64_t
+segmented_log::load_lowest_proposal_id ()
+{
+   if (segments_.empty () == true)
+   {
+      return 0;
+   }
+
+   return segments_.begin ()->second.first_proposal_id;
+}
+
+/*! virtual */ void
+segmented_log::store (
+   int64_t              proposal_id,
+   std::string const &  byte_array)
+{
+   PAXOS_ASSERT_GT (proposal_id, 0);
+   PAXOS_ASSERT_EQ (highest_proposal_id (), (proposal_id - 1));
+
+   if (segments_.empty () == true
+       || segments_.rbegin ()->second.size >= segment_size_)
+   {
+      this->create_segment (proposal_id);
+   }
+
+   struct segment & segment = segments_.rbegin ()->second;
+
+   std::string header;
+   detail::util::binary_writer writer (header);
+
+   writer.write_uint32 (byte_array.size ());
+   writer.write_uint32 (0);
+   writer.write_uint64 (proposal_id);
+
+   /*!
+     The checksum covers the proposal id as well as the value itself.
+    */
+   boost::crc_32_type checksum;
+   checksum.process_bytes (header.data () + 8, 8);
+   checksum.process_bytes (byte_array.data (), byte_array.size ());
+
+   std::string crc;
+   detail::util::binary_writer (crc).write_uint32 (checksum.checksum ());
+   header.replace (4, 4, crc);
+
+   PAXOS_ASSERT_EQ (header.size (), header_size);
+
+   struct iovec buffers[2];
+   buffers[0].iov_base = const_cast <char *> (header.data ());
+   buffers[0].iov_len  = header.size ();
+   buffers[1].iov_base = const_cast <char *> (byte_array.data ());
+   buffers[1].iov_len  = byte_array.size ();
+
+   /*!
+     If we fail halfway, the next record will overwrite whatever was written; if we crash
+     halfway, the incomplete record is discarded when the log is opened again.
+    */
+   ssize_t written = pwritev (segment.file, buffers, 2, segment.size);
+   PAXOS_CHECK_THROW (
+      written != static_cast <ssize_t> (header.size () + byte_array.size ()),
+      exception::storage_error ());
+
+   /*!
+     The value must be on disk before we tell the leader we have accepted it.
+    */
+   PAXOS_CHECK_THROW (
+      sync_ == true && fdatasync (segment.file) != 0,
+      exception::storage_error ());
+
+   if ((proposal_id - segment.first_proposal_id) % index_interval == 0)
+   {
+      segment.index.push_back (segment.size);
+   }
+
+   segment.size             += written;
+   segment.last_proposal_id  = proposal_id;
+}
+
+/*! virtual */ void
+segmented_log::remove (
+   int64_t      proposal_id)
+{
+   /*!
+     We can only delete entire segments, and never delete the segment we are appending to.
+    */
+   while (segments_.size () > 1
+          && segments_.begin ()->second.last_proposal_id < proposal_id)
+   {
+      PAXOS_DEBUG (this << " deleting segment starting at " << segments_.begin ()->first);
+
+      this->delete_segment (segments_.begin ()->second);
+      segments_.erase (segments_.begin ());
+   }
+}
+
+
+void
+segmented_log::open_segments ()
+{
+   DIR * directory = opendir (directory_.c_str ());
+   PAXOS_CHECK_THROW (directory == NULL, exception::storage_error ());
+
+   std::vector <int64_t> first_proposal_ids;
+
+   while (struct dirent * entry = readdir (directory))
+   {
+      long long first_proposal_id;
+      char      suffix;
+
+      /*!
+        Segments are named after the first proposal they contain; see segment_filename ().
+       */
+      if (strlen (entry->d_name) == 24
+          && sscanf (entry->d_name, "%20lld.lo%c", &first_proposal_id, &suffix) == 2
+          && suffix == 'g'
+          && first_proposal_id > 0)
+      {
+         first_proposal_ids.push_back (first_proposal_id);
+      }
+   }
+
+   closedir (directory);
+
+   std::sort (first_proposal_ids.begin (), first_proposal_ids.end ());
+
+   bool damaged = false;
+
+   for (int64_t first_proposal_id : first_proposal_ids)
+   {
+      std::string filename = this->segment_filename (first_proposal_id);
+
+      int file = open (filename.c_str (), O_RDWR);
+      PAXOS_CHECK_THROW (file < 0, exception::storage_error ());
+
+      struct segment segment = { first_proposal_id, first_proposal_id - 1, file, 0, NULL, 0, {} };
+
+      /*!
+        Once a segment has been damaged, or when there is a gap between two segments, all
+        proposals after that point are useless: our history must be consecutive.
+       */
+      if (damaged == true
+          || (segments_.empty () == false
+              && first_proposal_id != segments_.rbegin ()->second.last_proposal_id + 1))
+      {
+         PAXOS_WARN ("discarding segment " << filename << " after damaged history");
+         damaged = true;
+      }
+      else
+      {
+         damaged = (this->recover_segment (segment) == false);
+      }
+
+      if (segment.size == 0)
+      {
+         this->delete_segment (segment);
+         continue;
+      }
+
+      segments_.insert (std::make_pair (first_proposal_id, segment));
+   }
+}
+
+
+bool
+segmented_log::recover_segment (
+   struct segment &     segment)
+{
+   struct stat status;
+   PAXOS_CHECK_THROW (fstat (segment.file, &status) != 0, exception::storage_error ());
+
+   segment.size = status.st_size;
+   this->map_segment (segment);
+
+   size_t offset = 0;
+
+   while (offset < segment.size)
+   {
+      int64_t        id;
+      char const *   byte_array;
+      size_t         byte_array_size;
+
+      size_t record_size = read_record (segment.mapping + offset,
+                                        segment.size - offset,
+                                        id,
+                                        byte_array,
+                                        byte_array_size);
+
+      if (record_size == 0
+          || id != segment.last_proposal_id + 1)
+      {
+         PAXOS_WARN ("discarding damaged record at offset " << offset << " of segment starting at "
+                     << segment.first_proposal_id);
+
+         segment.size = offset;
+         PAXOS_CHECK_THROW (ftruncate (segment.file, offset) != 0, exception::storage_error ());
+
+         return false;
+      }
+
+      if ((id - segment.first_proposal_id) % index_interval == 0)
+      {
+         segment.index.push_back (offset);
+      }
+
+      segment.last_proposal_id = id;
+      offset                  += record_size;
+   }
+
+   return true;
+}
+
+
+void
+segmented_log::create_segment (
+   int64_t      first_proposal_id)
+{
+   std::string filename = this->segment_filename (first_proposal_id);
+
+   PAXOS_DEBUG (this << " creating segment " << filename);
+
+   int file = open (filename.c_str (), O_RDWR | O_CREAT | O_TRUNC, 0644);
+   PAXOS_CHECK_THROW (file < 0, exception::storage_error ());
+
+   struct segment segment = { first_proposal_id, first_proposal_id - 1, file, 0, NULL, 0, {} };
+   segments_.insert (std::make_pair (first_proposal_id, segment));
+
+   if (sync_ == true)
+   {
+      /*!
+        The new file itself must survive a crash as well, which requires syncing the directory.
+       */
+      int directory = open (directory_.c_str (), O_RDONLY);
+      PAXOS_CHECK_THROW (directory < 0, exception::storage_error ());
+
+      int result = fsync (directory);
+      close (directory);
+
+      PAXOS_CHECK_THROW (result != 0, exception::storage_error ());
+   }
+}
+
+
+void
+segmented_log::delete_segment (
+   struct segment &     segment)
+{
+   if (segment.mapping != NULL)
+   {
+      munmap (const_cast <char *> (segment.mapping), segment.mapping_size);
+      segment.mapping = NULL;
+   }
+
+   close (segment.file);
+
+   PAXOS_CHECK_THROW (
+      unlink (this->segment_filename (segment.first_proposal_id).c_str ()) != 0,
+      exception::storage_error ());
+}
+
+
+void
+segmented_log::map_segment (
+   struct segment &     segment)
+{
+   if (segment.size <= segment.mapping_size)
+   {
+      return;
+   }
+
+   if (segment.mapping != NULL)
+   {
+      munmap (const_cast <char *> (segment.mapping), segment.mapping_size);
+      segment.mapping = NULL;
+   }
+
+   /*!
+     Mapping beyond the end of the file is allowed, as long as we do not touch those pages
+     until the file has grown; this way, the segment we are appending to only needs to be
+     mapped once.
+    */
+   size_t mapping_size = std::max (segment.size, segment_size_ + segment_size_ / 4);
+
+   void * mapping = mmap (NULL, mapping_size, PROT_READ, MAP_SHARED, segment.file, 0);
+   PAXOS_CHECK_THROW (mapping == MAP_FAILED, exception::storage_error ());
+
+   segment.mapping      = static_cast <char const *> (mapping);
+   segment.mapping_size = mapping_size;
+}
+
+
+std::string
+segmented_log::segment_filename (
+   int64_t      first_proposal_id) const
+{
+   char filename[32];
+   snprintf (filename, sizeof (filename), "%020lld.log", static_cast <long long> (first_proposal_id));
+
+   return directory_ + "/" + filename;
+}
+
+
+/*! static */ size_t
+segmented_log::read_record (
+   char const *         data,
+   size_t               size,
+   int64_t &            proposal_id,
+   char const * &       byte_array,
+   size_t &             byte_array_size)
+{
+   detail::util::binary_reader reader (data, size);
+
+   uint32_t length;
+   uint32_t crc;
+   uint64_t id;
+
+   if (reader.read_uint32 (length) == false
+       || reader.read_uint32 (crc) == false
+       || reader.read_uint64 (id) == false
+       || length > size - header_size)
+   {
+      return 0;
+   }
+
+   boost::crc_32_type checksum;
+   checksum.process_bytes (data + 8, 8 + length);
+
+   if (checksum.checksum () != crc)
+   {
+      return 0;
+   }
+
+   proposal_id     = static_cast <int64_t> (id);
+   byte_array      = data + header_size;
+   byte_array_size = length;
+
+   return header_size + length;
+}
+
+}; };
@@ -0,0 +1,209 @@
+/*!
+  Copyright (c) 2012, Leon Mergen, all rights reserved.
+ */
+
+#ifndef LIBPAXOS_CPP_DURABLE_SEGMENTED_LOG_HPP
+#define LIBPAXOS_CPP_DURABLE_SEGMENTED_LOG_HPP
+
+#include <vector>
+
+#include "storage.hpp"
+
+namespace paxos { namespace durable {
+
+/*!
+  \brief Provides durable paxos::server backend based on append-only log files
+
+  This class provides a durable storage backend that does not depend on any external library.
+  All accepted values are appended to a log file within a specific directory; every record
+  within this log is prefixed with its length and a checksum, so that a record that was only
+  partially written when a server crashed is detected and discarded when the log is opened
+  again.
+
+  The log is split up in segments of roughly equal size. Once a segment has grown beyond the
+  configured size, a new segment is started; removing old history deletes entire segments that
+  only contain proposals that are no longer needed. Note that this means more history may be kept
+  than strictly necessary, never less.
+
+  The segments are memory mapped when values are retrieved, and a sparse index from proposal id
+  to location within the segment is kept in memory, which allows a follower that is catching up
+  to be served without any additional system calls.
+
+  When a paxos::server is restarted using a previously used directory, it continues from the
+  previous state.
+
+  \par Thread Safety
+  \e Distinct \e objects: Safe, as long as different directories are used\n
+  \e Shared \e objects: Unsafe\n
+
+  \par Examples
+
+  Set up a paxos::server that stores its history in a directory called "history".
+
+  \code{.cpp}
+
+  paxos::configuration configuration;
+  configuration.set_durable_storage (new paxos::durable::segmented_log ("history"));
+  paxos::server server ("127.0.0.1", 1337,
+                        [] (int64_t proposal_id, std::string const & input) -> std::string
+                        {
+                            return input;
+                        },
+                        configuration);
+
+  \endcode
+ */
+class segmented_log : public storage
+{
+public:
+
+   /*!
+     \brief Constructor
+     \param directory           Directory where the log segments are stored, which is created
+                                if it does not exist yet
+     \param segment_size        Size in bytes after which a new segment is started
+     \param sync                Whether to wait for every accepted value to reach the disk
+     \throws exception::storage_error Thrown when the log could not be opened
+    */
+   segmented_log (
+      std::string const &       directory,
+      size_t                    segment_size = 64 * 1024 * 1024,
+      bool                      sync = true);
+
+   /*!
+     \brief Destructor
+    */
+   virtual ~segmented_log ();
+
+protected:
+
+   virtual std::map <int64_t, std::string>
+   load_history (
+      int64_t                   proposal_id,
+      size_t                    max_entries,
+      size_t                    max_bytes);
+
+   virtual int64_t
+   load_highest_proposal_id ();
+
+   virtual int64_t
+   load_lowest_proposal_id ();
+
+   virtual void
+   store (
+      int64_t                   proposal_id,
+      std::string const &       byte_array);
+
+   virtual void
+   remove (
+      int64_t                   proposal_id);
+
+private:
+
+   /*!
+     \brief A single log file, which contains a consecutive range of proposals
+    */
+   struct segment
+   {
+      int64_t                   first_proposal_id;
+      int64_t                   last_proposal_id;
+
+      int                       file;
+
+      /*!
+        \brief Amount of bytes of the file that contain valid records
+       */
+      size_t                    size;
+
+      /*!
+        \brief Read-only mapping of the file, or NULL if it has not been mapped yet
+
+        The mapping of the segment we are appending to is larger than the file itself, so
+        that appended records become visible without mapping the file again.
+       */
+      char const *              mapping;
+      size_t                    mapping_size;
+
+      /*!
+        \brief Offset of every index_interval'th record, starting with first_proposal_id
+       */
+      std::vector <size_t>      index;
+   };
+
+   /*!
+     \brief Opens all existing segments and discards everything after a damaged record
+    */
+   void
+   open_segments ();
+
+   /*!
+     \brief Reads all records of a segment, and builds its index
+     \returns Returns false if the segment ends with a damaged or incomplete record, in which
+              case the segment has been truncated to the last valid record
+    */
+   bool
+   recover_segment (
+      struct segment &          segment);
+
+   /*!
+     \brief Starts a new, empty segment to append to
+    */
+   void
+   create_segment (
+      int64_t                   first_proposal_id);
+
+   /*!
+     \brief Closes a segment and deletes its file
+    */
+   void
+   delete_segment (
+      struct segment &          segment);
+
+   /*!
+     \brief Ensures all valid records of a segment are mapped in memory
+    */
+   void
+   map_segment (
+      struct segment &          segment);
+
+   std::string
+   segment_filename (
+      int64_t                   first_proposal_id) const;
+
+   /*!
+     \brief Decodes a single record
+     \returns Returns the size of the entire record, or 0 if no valid record is stored at \c data
+    */
+   static size_t
+   read_record (
+      char const *              data,
+      size_t                    size,
+      int64_t &                 proposal_id,
+      char const * &            byte_array,
+      size_t &                  byte_array_size);
+
+private:
+
+   /*!
+     \brief Size of the header that precedes every record: its length, checksum and proposal id
+    */
+   static size_t const          header_size = 16;
+
+   /*!
+     \brief Amount of records between two consecutive entries of a segment's index
+    */
+   static size_t const          index_interval = 64;
+
+   std::string                  directory_;
+   size_t                       segment_size_;
+   bool                         sync_;
+
+   /*!
+     \brief All segments, ordered by the first proposal id they contain
+    */
+   std::map <int64_t, segment>  segments_;
+};
+
+} }
+
+#endif  //! LIBPAXOS_CPP_DURABLE_SEGMENTED_LOG_HPP
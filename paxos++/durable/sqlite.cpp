@@ -1,6 +1,4 @@
 
-#include <boost/lexical_cast.hpp>
-
 #include "../exception/exception.hpp"
 #include "../detail/util/debug.hpp"
 
@@ -9,7 +7,9 @@
 namespace paxos { namespace durable {
 
 sqlite::sqlite (
-   std::string const &  filename)
+   std::string const &          filename,
+   bool                         write_ahead_log,
+   enum synchronous_mode        synchronous)
    : filename_ (filename),
      db_ (NULL)
 {
@@ -17,131 +17,154 @@ sqlite::sqlite (
    PAXOS_ASSERT_EQ (sqlite3_open (filename.c_str (), &db_), SQLITE_OK);
    PAXOS_ASSERT (db_ != NULL);
 
+   if (write_ahead_log == true)
+   {
+      PAXOS_ASSERT_EQ (
+         sqlite3_exec (db_,
+                       "PRAGMA journal_mode = WAL",
+                       NULL,
+                       NULL,
+                       NULL), SQLITE_OK);
+   }
+
+   char const * synchronous_pragma = NULL;
+
+   switch (synchronous)
+   {
+         case synchronous_off:
+            synchronous_pragma = "PRAGMA synchronous = OFF";
+            break;
+
+         case synchronous_normal:
+            synchronous_pragma = "PRAGMA synchronous = NORMAL";
+            break;
+
+         case synchronous_full:
+            synchronous_pragma = "PRAGMA synchronous = FULL";
+            break;
+   };
+
+   PAXOS_ASSERT (synchronous_pragma != NULL);
+   PAXOS_ASSERT_EQ (
+      sqlite3_exec (db_,
+                    synchronous_pragma,
+                    NULL,
+                    NULL,
+                    NULL), SQLITE_OK);
+
    if (this->has_table () == false)
    {
       this->create_table ();
    }
+
+   begin_statement_ = 
+      prepare ("BEGIN IMMEDIATE");
+
+   commit_statement_ = 
+      prepare ("COMMIT");
+
+   retrieve_statement_ = 
+      prepare ("SELECT "
+               "  id, "
+               "  byte_array "
+               "FROM "
+               "  history "
+               "WHERE "
+               "  id > ? "
+               "ORDER BY "
+               "  id ASC "
+               "LIMIT ?");
+
+   highest_proposal_id_statement_ = 
+      prepare ("SELECT "
+               "  MAX (id) "
+               "FROM "
+               "  history");
+
+   lowest_proposal_id_statement_ = 
+      prepare ("SELECT "
+               "  MIN (id) "
+               "FROM "
+               "  history");
+
+   store_statement_ = 
+      prepare ("INSERT INTO "
+               "  history ("
+               "    id, "
+               "    byte_array) "
+               "VALUES (?, ?)");
+
+   remove_statement_ = 
+      prepare ("DELETE FROM "
+               "  history "
+               "WHERE "
+               "  id < ?");
 }
 
 /*! virtual */ sqlite::~sqlite ()
 {
    PAXOS_INFO ("shutting down sqlite backend");
+
+   for (sqlite3_stmt * statement : { begin_statement_,
+                                     commit_statement_,
+                                     retrieve_statement_,
+                                     highest_proposal_id_statement_,
+                                     lowest_proposal_id_statement_,
+                                     store_statement_,
+                                     remove_statement_ })
+   {
+      PAXOS_ASSERT_EQ (sqlite3_finalize (statement), SQLITE_OK);
+   }
+
    PAXOS_ASSERT_EQ (sqlite3_close (db_), SQLITE_OK);
 }
 
 /*! virtual */ std::map <int64_t, std::string>
-sqlite::retrieve (
-   int64_t      proposal_id)
+sqlite::load_history (
+   int64_t      proposal_id,
+   size_t       max_entries,
+   size_t       max_bytes)
 {
    std::map <int64_t, std::string> result;
+   size_t                          bytes = 0;
 
-   std::string query = 
-      "SELECT "
-      "  id, "
-      "  byte_array "
-      "FROM "
-      "  history "
-      "WHERE "
-      "  id > " + boost::lexical_cast <std::string> (proposal_id);
-
-
-   PAXOS_DEBUG ("executing query: " << query);
-
-   sqlite3_stmt * prepared_statement = 0;
-   PAXOS_ASSERT_EQ (sqlite3_prepare (db_,
-                                     query.c_str (),
-                                     query.length (),
-                                     &prepared_statement,
-                                     NULL), SQLITE_OK);
+   PAXOS_ASSERT_EQ (sqlite3_bind_int64 (retrieve_statement_, 1, proposal_id), SQLITE_OK);
+   PAXOS_ASSERT_EQ (sqlite3_bind_int64 (retrieve_statement_, 2, max_entries), SQLITE_OK);
 
-   while (sqlite3_step (prepared_statement) == SQLITE_ROW)
+   /*!
+     The amount of bytes cannot be expressed in the query itself, so we just stop stepping
+     through the results once we have enough.
+    */
+   while (bytes < max_bytes
+          && sqlite3_step (retrieve_statement_) == SQLITE_ROW)
    {
-      PAXOS_ASSERT_EQ (sqlite3_column_count (prepared_statement), 2);
+      PAXOS_ASSERT_EQ (sqlite3_column_count (retrieve_statement_), 2);
 
-      int64_t id               = sqlite3_column_int64 (prepared_statement, 0);
+      int64_t id               = sqlite3_column_int64 (retrieve_statement_, 0);
 
-      uint32_t byte_array_size = sqlite3_column_bytes (prepared_statement, 1);
-      void const * byte_array  = sqlite3_column_blob  (prepared_statement, 1);
+      uint32_t byte_array_size = sqlite3_column_bytes (retrieve_statement_, 1);
+      void const * byte_array  = sqlite3_column_blob  (retrieve_statement_, 1);
 
       result[id].append (static_cast <char const *> (byte_array), byte_array_size);
+      bytes += byte_array_size;
    }
-   
-
-   PAXOS_ASSERT_EQ (sqlite3_finalize (prepared_statement), SQLITE_OK);
 
+   reset (retrieve_statement_);
 
    return result;
 }
 
 /*! virtual */ int64_t
-sqlite::highest_proposal_id ()
+sqlite::load_highest_proposal_id ()
 {
-   std::string query = 
-      "SELECT "
-      "  MAX (id) "
-      "FROM "
-      "  history";
-
-   PAXOS_DEBUG ("executing query: " << query);
-
-   sqlite3_stmt * prepared_statement = 0;
-   PAXOS_ASSERT_EQ (sqlite3_prepare (db_,
-                                     query.c_str (),
-                                     query.length (),
-                                     &prepared_statement,
-                                     NULL), SQLITE_OK);
-
-   int64_t result = 0;
-
-   while (sqlite3_step (prepared_statement) == SQLITE_ROW)
-   {
-      PAXOS_ASSERT_EQ (result, 0);
-      PAXOS_ASSERT_EQ (sqlite3_column_count (prepared_statement), 1);
-
-      result = sqlite3_column_int64 (prepared_statement, 0);
-
-      PAXOS_ASSERT_GE (result, 0);
-   }
-
-   PAXOS_ASSERT_EQ (sqlite3_finalize (prepared_statement), SQLITE_OK);
-
-   return result;
+   return select_int64 (highest_proposal_id_statement_);
 }
 
 
 /*! virtual */ int64_t
-sqlite::lowest_proposal_id ()
+sqlite::load_lowest_proposal_id ()
 {
-   std::string query = 
-      "SELECT "
-      "  MIN (id) "
-      "FROM "
-      "  history";
-
-   PAXOS_DEBUG ("executing query: " << query);
-
-   sqlite3_stmt * prepared_statement = 0;
-   PAXOS_ASSERT_EQ (sqlite3_prepare (db_,
-                                     query.c_str (),
-                                     query.length (),
-                                     &prepared_statement,
-                                     NULL), SQLITE_OK);
-
-   int64_t result = 0;
-
-   while (sqlite3_step (prepared_statement) == SQLITE_ROW)
-   {
-      PAXOS_ASSERT_EQ (result, 0);
-      PAXOS_ASSERT_EQ (sqlite3_column_count (prepared_statement), 1);
-
-      result = sqlite3_column_int64 (prepared_statement, 0);
-
-      PAXOS_ASSERT_GE (result, 0);
-   }
-
-   PAXOS_ASSERT_EQ (sqlite3_finalize (prepared_statement), SQLITE_OK);
-
-   return result;
+   return select_int64 (lowest_proposal_id_statement_);
 }
 
 /*! virtual */ void
@@ -152,52 +175,38 @@ sqlite::store (
    PAXOS_ASSERT_GT (proposal_id, 0);
 
    /*!
-     This is a sanity check which could really be removed in production, but let's just
-     keep it here for now. It ensures important things are sane, and we do not have any
-     "gaps" in our history.
+     This is a sanity check which ensures we do not have any "gaps" in our history. Note
+     that this uses the proposal id cached by our base class, and thus does not execute
+     another query.
     */
    PAXOS_ASSERT_EQ (highest_proposal_id (), (proposal_id - 1));
 
-   std::string query =
-      "INSERT INTO "
-      "  history ("
-      "    id, "
-      "    byte_array) "
-      "VALUES (" 
-      "  " + boost::lexical_cast <std::string> (proposal_id) + ", "
-      "  ?)";
-
-   PAXOS_DEBUG ("executing query: " << query);
-
-   sqlite3_stmt * prepared_statement = 0;
-   PAXOS_ASSERT_EQ (sqlite3_prepare (db_,
-                                     query.c_str (),
-                                     query.length (),
-                                     &prepared_statement,
-                                     NULL), SQLITE_OK);
-
-   PAXOS_ASSERT_EQ (sqlite3_bind_blob (prepared_statement, 1, 
-                                       byte_array.c_str (), byte_array.length (), 
-                                       SQLITE_TRANSIENT), SQLITE_OK);
-
-   PAXOS_ASSERT_EQ (sqlite3_step (prepared_statement), SQLITE_DONE);
-   PAXOS_ASSERT_EQ (sqlite3_finalize (prepared_statement), SQLITE_OK);
+   PAXOS_ASSERT_EQ (sqlite3_bind_int64 (store_statement_, 1, proposal_id), SQLITE_OK);
+
+   /*!
+     The blob only has to stay alive until the statement has been executed, which allows
+     sqlite to use our buffer as-is instead of making a copy.
+    */
+   PAXOS_ASSERT_EQ (sqlite3_bind_blob (store_statement_, 2, 
+                                       byte_array.data (), byte_array.length (), 
+                                       SQLITE_STATIC), SQLITE_OK);
+
+   /*!
+     Every proposal is committed in its own transaction, since it must be durable before we
+     tell the leader we have accepted it.
+    */
+   execute (begin_statement_);
+   execute (store_statement_);
+   execute (commit_statement_);
 }
 
 void
 sqlite::remove (
    int64_t      proposal_id)
 {
-   PAXOS_ASSERT_EQ (
-      sqlite3_exec (db_,
-                    std::string (
-                       "DELETE FROM "
-                       "  history "
-                       "WHERE"
-                       " id < " + boost::lexical_cast <std::string> (proposal_id)).c_str (),
-                    NULL,
-                    NULL,
-                    NULL), SQLITE_OK);
+   PAXOS_ASSERT_EQ (sqlite3_bind_int64 (remove_statement_, 1, proposal_id), SQLITE_OK);
+
+   execute (remove_statement_);
 }
 
 
@@ -218,35 +227,79 @@ sqlite::create_table ()
 bool
 sqlite::has_table ()
 {
-   std::string query = 
-      "SELECT "
-      "  COUNT (*) "
-      "FROM "
-      "  sqlite_master "
-      "WHERE "
-      "  type = 'table' "
-      "  AND name = 'history'";
-
-   sqlite3_stmt * prepared_statement = 0;
-   PAXOS_ASSERT_EQ (sqlite3_prepare (db_,
-                                     query.c_str (),
-                                     query.length (),
-                                     &prepared_statement,
-                                     NULL), SQLITE_OK);
+   sqlite3_stmt * statement = 
+      prepare ("SELECT "
+               "  COUNT (*) "
+               "FROM "
+               "  sqlite_master "
+               "WHERE "
+               "  type = 'table' "
+               "  AND name = 'history'");
+
+   int64_t result = select_int64 (statement);
 
+   PAXOS_ASSERT_EQ (sqlite3_finalize (statement), SQLITE_OK);
+
+   return result == 1;
+}
+
+
+sqlite3_stmt *
+sqlite::prepare (
+   std::string const &  query)
+{
+   PAXOS_DEBUG ("preparing query: " << query);
+
+   sqlite3_stmt * statement = 0;
+   PAXOS_ASSERT_EQ (sqlite3_prepare_v2 (db_,
+                                        query.c_str (),
+                                        query.length (),
+                                        &statement,
+                                        NULL), SQLITE_OK);
+   PAXOS_ASSERT (statement != 0);
+
+   return statement;
+}
+
+
+/*! static */ void
+sqlite::reset (
+   sqlite3_stmt *       statement)
+{
+   PAXOS_ASSERT_EQ (sqlite3_reset (statement), SQLITE_OK);
+   PAXOS_ASSERT_EQ (sqlite3_clear_bindings (statement), SQLITE_OK);
+}
+
+
+int64_t
+sqlite::select_int64 (
+   sqlite3_stmt *       statement)
+{
    int64_t result = 0;
 
-   while (sqlite3_step (prepared_statement) == SQLITE_ROW)
+   while (sqlite3_step (statement) == SQLITE_ROW)
    {
       PAXOS_ASSERT_EQ (result, 0);
-      PAXOS_ASSERT_EQ (sqlite3_column_count (prepared_statement), 1);
+      PAXOS_ASSERT_EQ (sqlite3_column_count (statement), 1);
+
+      result = sqlite3_column_int64 (statement, 0);
 
-      result = sqlite3_column_int64 (prepared_statement, 0);
+      PAXOS_ASSERT_GE (result, 0);
    }
 
-   PAXOS_ASSERT_EQ (sqlite3_finalize (prepared_statement), SQLITE_OK);
+   reset (statement);
 
-   return result == 1;
+   return result;
+}
+
+
+void
+sqlite::execute (
+   sqlite3_stmt *       statement)
+{
+   PAXOS_ASSERT_EQ (sqlite3_step (statement), SQLITE_DONE);
+
+   reset (statement);
 }
 
 }; };
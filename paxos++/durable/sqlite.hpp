@@ -43,33 +43,58 @@ namespace paxos { namespace durable {
  */
 class sqlite : public storage
 {
+public:
+
+   /*!
+     \brief Controls how often sqlite waits for data to reach the disk
+
+     See the documentation of sqlite's "PRAGMA synchronous" for the exact guarantees.
+    */
+   enum synchronous_mode
+   {
+      //! Never wait for the disk; a power loss can corrupt the database
+      synchronous_off,
+
+      //! Only wait for the disk at critical moments; in write-ahead log mode, a power loss can
+      //! lose the most recent proposals, but never corrupts the database
+      synchronous_normal,
+
+      //! Wait for the disk at every commit
+      synchronous_full
+   };
+
 public:
 
    /*!
      \brief Constructor
-     \param filename    Location where sqlite database is stored
+     \param filename            Location where sqlite database is stored
+     \param write_ahead_log     Whether to use sqlite's write-ahead log instead of a rollback journal,
+                                which only requires one write to disk per commit
+     \param synchronous         Controls how often sqlite waits for data to reach the disk
     */
    sqlite (
-      std::string const &       filename);
+      std::string const &       filename,
+      bool                      write_ahead_log = false,
+      enum synchronous_mode     synchronous = synchronous_full);
 
    /*!
      \brief Destructor
     */
    virtual ~sqlite ();
 
-public:
+protected:
 
    virtual std::map <int64_t, std::string>
-   retrieve (
-      int64_t                                                   proposal_id);
+   load_history (
+      int64_t                   proposal_id,
+      size_t                    max_entries,
+      size_t                    max_bytes);
 
    virtual int64_t
-   highest_proposal_id ();
+   load_highest_proposal_id ();
 
    virtual int64_t
-   lowest_proposal_id ();
-
-protected:
+   load_lowest_proposal_id ();
 
    virtual void
    store (
@@ -89,10 +114,49 @@ private:
    void
    create_table ();
 
+   /*!
+     \brief Prepares a statement that is kept for the lifetime of this object
+    */
+   sqlite3_stmt *
+   prepare (
+      std::string const &       query);
+
+   /*!
+     \brief Resets a statement after it has been executed, so that it can be executed again
+    */
+   static void
+   reset (
+      sqlite3_stmt *            statement);
+
+   /*!
+     \brief Looks up a single integer using a prepared statement
+    */
+   int64_t
+   select_int64 (
+      sqlite3_stmt *            statement);
+
+   /*!
+     \brief Executes a statement that does not return any rows
+    */
+   void
+   execute (
+      sqlite3_stmt *            statement);
+
 private:
 
-   std::string  filename_;
-   sqlite3 *    db_;
+   std::string          filename_;
+   sqlite3 *            db_;
+
+   /*!
+     \brief Statements used by the various operations, which are prepared once in our constructor
+    */
+   sqlite3_stmt *       begin_statement_;
+   sqlite3_stmt *       commit_statement_;
+   sqlite3_stmt *       retrieve_statement_;
+   sqlite3_stmt *       highest_proposal_id_statement_;
+   sqlite3_stmt *       lowest_proposal_id_statement_;
+   sqlite3_stmt *       store_statement_;
+   sqlite3_stmt *       remove_statement_;
 };
 
 } }
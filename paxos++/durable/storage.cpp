@@ -5,7 +5,9 @@
 namespace paxos { namespace durable {
 
 storage::storage ()
-   : history_size_ (10000)
+   : history_size_ (10000),
+     catchup_max_entries_ (1000),
+     catchup_max_bytes_ (1024 * 1024)
 {
 }
 
@@ -26,15 +28,83 @@ storage::history_size () const
    return history_size_;
 }
 
+void
+storage::set_catchup_max_entries (
+   size_t       amount)
+{
+   PAXOS_ASSERT_GT (amount, 0);
+   catchup_max_entries_ = amount;
+}
+
+size_t
+storage::catchup_max_entries () const
+{
+   return catchup_max_entries_;
+}
+
+void
+storage::set_catchup_max_bytes (
+   size_t       bytes)
+{
+   PAXOS_ASSERT_GT (bytes, 0);
+   catchup_max_bytes_ = bytes;
+}
+
+size_t
+storage::catchup_max_bytes () const
+{
+   return catchup_max_bytes_;
+}
+
+std::map <int64_t, std::string>
+storage::retrieve (
+   int64_t      proposal_id)
+{
+   return load_history (proposal_id,
+                        catchup_max_entries_,
+                        catchup_max_bytes_);
+}
+
+int64_t
+storage::highest_proposal_id ()
+{
+   if (highest_proposal_id_.is_initialized () == false)
+   {
+      highest_proposal_id_ = load_highest_proposal_id ();
+   }
+
+   return *highest_proposal_id_;
+}
+
+int64_t
+storage::lowest_proposal_id ()
+{
+   if (lowest_proposal_id_.is_initialized () == false)
+   {
+      lowest_proposal_id_ = load_lowest_proposal_id ();
+   }
+
+   return *lowest_proposal_id_;
+}
+
 void
 storage::accept (
    int64_t                      proposal_id,
    std::string const &          byte_array,
    int64_t                      lowest_proposal_id)
 {
+   PAXOS_ASSERT_EQ (highest_proposal_id (), proposal_id - 1);
+
    store (proposal_id,
           byte_array);
 
+   highest_proposal_id_ = proposal_id;
+
+   if (this->lowest_proposal_id () == 0)
+   {
+      lowest_proposal_id_ = proposal_id;
+   }
+
    PAXOS_DEBUG ("proposal_id = " << proposal_id << ", history_size_ = " << history_size_);
 
    /*!
@@ -65,6 +135,11 @@ storage::accept (
       PAXOS_DEBUG ("highest_proposal_id_to_remove = " << highest_proposal_id_to_remove);
 
       remove (highest_proposal_id_to_remove);
+
+      /*!
+        Removing history is rare enough that we can just ask the backend what is left.
+       */
+      lowest_proposal_id_ = load_lowest_proposal_id ();
    }
 }
 
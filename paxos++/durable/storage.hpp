@@ -11,6 +11,7 @@
 #include <string>
 
 #include <boost/function.hpp>
+#include <boost/optional.hpp>
 
 namespace paxos { namespace durable {
 
@@ -54,6 +55,44 @@ public:
     */
    int64_t
    history_size () const;
+
+   /*!
+     \brief Controls the maximum amount of values retrieve () returns at once
+     \param amount The maximum amount of values
+
+     When a follower lags behind, the leader sends it the missing history in several batches
+     of at most this amount of values, rather than in one huge message that blocks the rest of
+     the quorum while it is being transferred.
+
+     Defaults to 1000.
+    */
+   void
+   set_catchup_max_entries (
+      size_t    amount);
+
+   /*!
+     \brief Access to the maximum amount of values retrieve () returns at once
+    */
+   size_t
+   catchup_max_entries () const;
+
+   /*!
+     \brief Controls the maximum size of the values retrieve () returns at once
+     \param bytes The maximum combined size of all values
+
+     A single value that is larger than this is still returned on its own.
+
+     Defaults to 1 MiB.
+    */
+   void
+   set_catchup_max_bytes (
+      size_t    bytes);
+
+   /*!
+     \brief Access to the maximum size of the values retrieve () returns at once
+    */
+   size_t
+   catchup_max_bytes () const;
    
 
    /*!
@@ -61,6 +100,7 @@ public:
      \param proposal_id         Proposal id of value
      \param byte_array          The actual value
      \param lowest_proposal_id  Highest proposal_id that has been accepted by the entire quorum
+     \throws exception::storage_error Thrown when the value could not be stored
 
      This function calls store (), and if the size of the history is growing too large
      calls for a cleanup.
@@ -72,38 +112,72 @@ public:
       int64_t                   lowest_proposal_id);
 
    /*!
-     \brief Looks up all recently accepted values higher than with \c proposal_id
+     \brief Looks up the recently accepted values following \c proposal_id
 
-     This function does not necessarily need to return all values. In fact, it is preferred if
-     a large catch-up is retrieved in small batches, so that a catch-up can occur gradually 
-     instead of in a single paxos round.
+     Returns a consecutive batch of values, limited by catchup_max_entries () and
+     catchup_max_bytes (), so that a large catch-up occurs gradually instead of in a single
+     paxos round.
    */
-   virtual std::map <int64_t, std::string>
+   std::map <int64_t, std::string>
    retrieve (
-      int64_t                   proposal_id) = 0;
+      int64_t                   proposal_id);
 
    /*!
-     \brief Looks up the highest proposal id currently stored
+     \brief Access to the highest proposal id currently stored
      \returns Returns highest proposal id in history, or 0 if no previous proposals are stored
+
+     This is called several times for every paxos command, so it is kept in memory: the backend
+     is only asked for it once, after which it is kept up-to-date by accept ().
     */
-   virtual int64_t
-   highest_proposal_id () = 0;
+   int64_t
+   highest_proposal_id ();
 
    /*!
-     \brief Looks up the lowest proposal id currently stored
+     \brief Access to the lowest proposal id currently stored
      \returns Returns the lowest proposal id in history, or 0 if no previous proposals are stored
 
      This functionality is not really required by the paxos library, but is used by the test cases.
     */
-   virtual int64_t
-   lowest_proposal_id () = 0;
+   int64_t
+   lowest_proposal_id ();
 
 protected:
 
+   /*!
+     \brief Looks up the accepted values following \c proposal_id in the backend
+     \param proposal_id The proposal id after which to start
+     \param max_entries Maximum amount of values to return
+     \param max_bytes   Maximum combined size of values to return, unless the first value is
+                        larger than that on its own
+
+     Values must be returned in order, without any gaps.
+    */
+   virtual std::map <int64_t, std::string>
+   load_history (
+      int64_t                   proposal_id,
+      size_t                    max_entries,
+      size_t                    max_bytes) = 0;
+
+   /*!
+     \brief Looks up the highest proposal id currently stored in the backend
+     \returns Returns highest proposal id in history, or 0 if no previous proposals are stored
+    */
+   virtual int64_t
+   load_highest_proposal_id () = 0;
+
+   /*!
+     \brief Looks up the lowest proposal id currently stored in the backend
+     \returns Returns the lowest proposal id in history, or 0 if no previous proposals are stored
+    */
+   virtual int64_t
+   load_lowest_proposal_id () = 0;
+
    /*!
      \brief Stores an accepted value
      \param proposal_id The id of the proposal to store
      \param byte_array  The value that is associated with the proposal
+     \throws exception::storage_error Thrown when the value could not be stored, in which case
+                                      the backend must be left as if store () was never called
 
      \par Preconditions
      
@@ -111,7 +185,7 @@ protected:
 
      \par Postconditions
 
-     highest_proposal_id () == proposal_id
+     load_highest_proposal_id () == proposal_id
 
     */
    virtual void
@@ -129,7 +203,18 @@ protected:
 
 private:
 
-   int64_t      history_size_;
+   int64_t                      history_size_;
+   size_t                       catchup_max_entries_;
+   size_t                       catchup_max_bytes_;
+
+   /*!
+     \brief Cached results of load_highest_proposal_id () and load_lowest_proposal_id ()
+
+     These cannot be loaded from our constructor, since the backend has not been constructed
+     yet at that point.
+    */
+   boost::optional <int64_t>    highest_proposal_id_;
+   boost::optional <int64_t>    lowest_proposal_id_;
 
 };
 
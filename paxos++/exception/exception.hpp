@@ -77,6 +77,13 @@ class incorrect_proposal : virtual public exception {};
  */
 class connection_close : virtual public exception {};
 
+/*!
+  \brief Thrown when a server replied with data that could not be decoded
+
+  Usually means that the client and the servers run different versions of the library.
+ */
+class protocol_mismatch : virtual public exception {};
+
 /*!
   \brief Thrown when an error occured with a durable storage component
  */
@@ -1,3 +1,4 @@
+#include <future>
 #include <iostream>
 #include <functional>
 
@@ -68,7 +69,8 @@ server::server (
                  boost::asio::ip::address::from_string (host), port),
               configuration),
 
-     state_ (processor,
+     state_ (io_service,
+             processor,
              configuration)
 {
    /*! 
@@ -97,6 +99,21 @@ server::stop ()
    io_thread_.stop ();
 }
 
+std::vector <connection_statistics>
+server::statistics ()
+{
+   std::promise <std::vector <connection_statistics> > promise;
+   std::future <std::vector <connection_statistics> > future = promise.get_future ();
+
+   acceptor_.get_io_service ().post (
+      [this, & promise] ()
+      {
+         promise.set_value (quorum_.connection_statistics ());
+      });
+
+   return future.get ();
+}
+
 
 void
 server::add (
@@ -7,6 +7,7 @@
 
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 #include <boost/asio/ip/tcp.hpp>
 
@@ -18,6 +19,7 @@
 #include "detail/tcp_connection_fwd.hpp"
 
 #include "configuration.hpp"
+#include "connection_statistics.hpp"
 
 namespace paxos {
 
@@ -233,6 +235,16 @@ public:
    void
    stop ();
 
+   /*!
+     \brief Statistics of the connections to the other servers in the quorum
+
+     Useful to find out whether a server cannot keep up with the data we send it. The
+     statistics are collected by the io_service, and this function blocks until that has
+     happened: it must never be called from a handler that runs on that io_service.
+    */
+   std::vector <connection_statistics>
+   statistics ();
+
 private:
 
    void
@@ -0,0 +1,91 @@
+/*!
+  Validates that a leader can combine requests of multiple clients into a single proposal,
+  while every client still receives the result of its own request.
+ */
+
+#include <atomic>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/configuration.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+int main ()
+{
+   std::atomic <uint16_t> response_count (0);
+
+   /*!
+     Every server gets its own callback, which validates all requests within a batch are
+     still processed one by one, and in order.
+    */
+   auto create_callback =
+      [& response_count](int64_t & last_proposal_id) -> paxos::server::callback_type
+      {
+         return
+            [& response_count, & last_proposal_id](int64_t proposal_id, std::string const & workload) -> std::string
+            {
+               PAXOS_ASSERT_EQ (proposal_id, last_proposal_id + 1);
+               last_proposal_id = proposal_id;
+
+               ++response_count;
+               return workload;
+            };
+      };
+
+   int64_t last_proposal_id1 = 0;
+   int64_t last_proposal_id2 = 0;
+   int64_t last_proposal_id3 = 0;
+
+   paxos::configuration configuration1;
+   paxos::configuration configuration2;
+   paxos::configuration configuration3;
+
+   configuration1.set_batch_max_entries (16);
+   configuration1.set_batch_linger (1000);
+   configuration2.set_batch_max_entries (16);
+   configuration2.set_batch_linger (1000);
+   configuration3.set_batch_max_entries (16);
+   configuration3.set_batch_linger (1000);
+
+   paxos::server server1 ("127.0.0.1", 1337, create_callback (last_proposal_id1), configuration1);
+   paxos::server server2 ("127.0.0.1", 1338, create_callback (last_proposal_id2), configuration2);
+   paxos::server server3 ("127.0.0.1", 1339, create_callback (last_proposal_id3), configuration3);
+
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   std::vector <paxos::client> clients (4);
+
+   for (paxos::client & client : clients)
+   {
+      client.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   }
+
+   std::vector <std::vector <std::future <std::string> > > futures (clients.size ());
+
+   for (size_t i = 0; i < 50; ++i)
+   {
+      for (size_t j = 0; j < clients.size (); ++j)
+      {
+         futures[j].push_back (
+            clients[j].send (boost::lexical_cast <std::string> (j * 1000 + i)));
+      }
+   }
+
+   for (size_t i = 0; i < 50; ++i)
+   {
+      for (size_t j = 0; j < clients.size (); ++j)
+      {
+         PAXOS_ASSERT_EQ (futures[j][i].get (),
+                          boost::lexical_cast <std::string> (j * 1000 + i));
+      }
+   }
+
+   PAXOS_ASSERT_GE (response_count.load (), 3 * 4 * 50);
+
+   PAXOS_INFO ("test succeeded");
+}
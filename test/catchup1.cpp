@@ -0,0 +1,175 @@
+/*!
+  Validates that a follower that lags behind more than a single batch of history is caught up
+  in several rounds, without failing the proposal that triggered the catch-up. Also validates
+  that a follower that reconnects while the leader has multiple proposals in progress is
+  caught up without failing any of them.
+ */
+
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/durable/heap.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+bool
+all_responses_equal (
+   std::map <int64_t, uint16_t> const & responses,
+   uint16_t                             count)
+{
+   for (auto const & i : responses)
+   {
+      if (i.second != count)
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+int main ()
+{
+   std::map <int64_t, uint16_t> responses;
+
+   /*!
+     Synchronizes access to responses
+    */
+   boost::mutex mutex;
+
+   paxos::configuration configuration1;
+   paxos::configuration configuration2;
+   paxos::configuration configuration3;
+
+   /*!
+     Note that the configuration objects below outlive the server objects declared later in
+     the test, thus providing semi-durable storage.
+    */
+   configuration1.set_durable_storage (
+      new paxos::durable::heap ());
+   configuration2.set_durable_storage (
+      new paxos::durable::heap ());
+   configuration3.set_durable_storage (
+      new paxos::durable::heap ());
+
+   configuration1.durable_storage ().set_catchup_max_entries (4);
+   configuration2.durable_storage ().set_catchup_max_entries (4);
+   configuration3.durable_storage ().set_catchup_max_entries (4);
+
+   configuration1.set_max_inflight_proposals (8);
+   configuration2.set_max_inflight_proposals (8);
+   configuration3.set_max_inflight_proposals (8);
+
+   paxos::server::callback_type callback = 
+      [& responses,
+       & mutex](
+         int64_t                promise_id,
+         std::string const &    workload) -> std::string
+      {
+         boost::mutex::scoped_lock lock (mutex);
+
+         if (responses.find (promise_id) == responses.end ())
+         {
+            responses[promise_id] = 1;
+         }
+         else
+         {
+            responses[promise_id]++;
+         }
+
+         PAXOS_ASSERT (responses[promise_id] <= 3);
+
+         /*!
+           Makes sure the leader still has proposals in progress that it has not stored
+           itself yet when server3 reconnects below.
+          */
+         boost::this_thread::sleep (boost::posix_time::milliseconds (1));
+
+         return "bar";
+      };
+
+   paxos::client client;
+   client.add  ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   paxos::server server1 ("127.0.0.1", 1337, callback, configuration1);
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   paxos::server server2 ("127.0.0.1", 1338, callback, configuration2);
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   {
+      paxos::server server3 ("127.0.0.1", 1339, callback, configuration3);
+      server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+      PAXOS_ASSERT_EQ (all_responses_equal (responses, 3), true);
+   }
+
+   /*!
+     Let server3 fall behind by many more proposals than fit in a single batch.
+    */
+   for (size_t i = 0; i < 50; ++i)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+   }
+
+   PAXOS_ASSERT_EQ (all_responses_equal (responses, 3), false);
+
+   {
+      paxos::server server3 ("127.0.0.1", 1339, callback, configuration3);
+      server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+      boost::this_thread::sleep (
+         boost::posix_time::milliseconds (
+            paxos::configuration ().timeout ()));
+
+      /*!
+        As soon as server3 is part of the quorum again, the next request catches it up
+        completely, without any error being sent to the client.
+       */
+      do
+      {
+         PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+
+      } while (configuration3.durable_storage ().highest_proposal_id () 
+               != configuration1.durable_storage ().highest_proposal_id ());
+
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+      PAXOS_ASSERT_EQ (configuration3.durable_storage ().highest_proposal_id (), 
+                       configuration1.durable_storage ().highest_proposal_id ());
+   }
+
+   for (size_t i = 0; i < 10; ++i)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+   }
+
+   /*!
+     Now let server3 reconnect while the leader has many proposals in progress, some of
+     which it has not stored itself yet when server3 is caught up.
+    */
+   paxos::server server3 ("127.0.0.1", 1339, callback, configuration3);
+   server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   do
+   {
+      std::vector <std::future <std::string> > futures;
+
+      for (size_t i = 0; i < 50; ++i)
+      {
+         futures.push_back (client.send ("foo"));
+      }
+
+      for (auto & future : futures)
+      {
+         PAXOS_ASSERT_EQ (future.get (), "bar");
+      }
+
+   } while (configuration3.durable_storage ().highest_proposal_id () 
+            != configuration1.durable_storage ().highest_proposal_id ());
+
+   PAXOS_INFO ("test succeeded");
+}
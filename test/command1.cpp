@@ -0,0 +1,62 @@
+/*!
+  Validates the binary wire format of commands: all fields must survive a round-trip, and
+  data that is truncated or encoded using another version must be rejected.
+ */
+
+#include <boost/uuid/random_generator.hpp>
+
+#include <paxos++/detail/command.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+int main ()
+{
+   paxos::detail::command command;
+
+   boost::uuids::uuid id = boost::uuids::random_generator () ();
+
+   command.set_type (paxos::detail::command::type_request_accept);
+   command.set_error_code (paxos::detail::error_incorrect_proposal);
+   command.set_host_id (id);
+   command.set_host_endpoint (
+      boost::asio::ip::tcp::endpoint (boost::asio::ip::address::from_string ("::1"), 1337));
+   command.set_next_proposal_id (-1);
+   command.set_highest_proposal_id (300);
+   command.set_lowest_proposal_id (static_cast <int64_t> (1) << 40);
+   command.set_workload (std::string ("foo\0bar", 7));
+   command.add_proposed_workload (299, "baz");
+   command.add_proposed_workload (300, std::string (100000, 'x'));
+
+   std::string encoded = paxos::detail::command::to_string (command);
+
+   boost::optional <paxos::detail::command> decoded =
+      paxos::detail::command::from_string (encoded.data (), encoded.size ());
+
+   PAXOS_ASSERT (decoded.is_initialized () == true);
+   PAXOS_ASSERT_EQ (decoded->type (), paxos::detail::command::type_request_accept);
+   PAXOS_ASSERT_EQ (decoded->error_code (), paxos::detail::error_incorrect_proposal);
+   PAXOS_ASSERT (decoded->host_id () == id);
+   PAXOS_ASSERT (decoded->host_endpoint () == command.host_endpoint ());
+   PAXOS_ASSERT_EQ (decoded->next_proposal_id (), -1);
+   PAXOS_ASSERT_EQ (decoded->highest_proposal_id (), 300);
+   PAXOS_ASSERT_EQ (decoded->lowest_proposal_id (), static_cast <int64_t> (1) << 40);
+   PAXOS_ASSERT (decoded->workload () == command.workload ());
+   PAXOS_ASSERT (decoded->proposed_workload () == command.proposed_workload ());
+
+   /*!
+     Any truncated command must be rejected, rather than be decoded into garbage.
+    */
+   for (size_t i = 0; i < 64; ++i)
+   {
+      PAXOS_ASSERT (paxos::detail::command::from_string (encoded.data (), i).is_initialized () == false);
+   }
+
+   PAXOS_ASSERT (paxos::detail::command::from_string (encoded.data (), encoded.size () - 1).is_initialized () == false);
+
+   /*!
+     And so must a command that is encoded using a different version of the wire format.
+    */
+   encoded[0] = paxos::detail::command::wire_version + 1;
+   PAXOS_ASSERT (paxos::detail::command::from_string (encoded.data (), encoded.size ()).is_initialized () == false);
+
+   PAXOS_INFO ("test succeeded");
+}
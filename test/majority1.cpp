@@ -0,0 +1,131 @@
+/*!
+  Validates that a leader that commits on a majority replies to clients while a follower is
+  still processing, and that the divergent responses of that follower are reported once it
+  catches up.
+ */
+
+#include <atomic>
+
+#include <boost/thread/thread.hpp>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/configuration.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+int main ()
+{
+   std::atomic <uint16_t> response_count (0);
+   std::atomic <uint16_t> divergence_count (0);
+   std::atomic <bool>     released (false);
+
+   paxos::server::callback_type callback =
+      [& response_count](int64_t, std::string const &) -> std::string
+      {
+         ++response_count;
+         return "bar";
+      };
+
+   /*!
+     The third server is very slow, and disagrees with the other servers.
+    */
+   paxos::server::callback_type slow_callback =
+      [& response_count, & released](int64_t, std::string const &) -> std::string
+      {
+         while (released.load () == false)
+         {
+            boost::this_thread::sleep (boost::posix_time::milliseconds (10));
+         }
+
+         ++response_count;
+         return "baz";
+      };
+
+   paxos::configuration::divergence_callback_type divergence_callback =
+      [& divergence_count](int64_t,
+                           boost::asio::ip::tcp::endpoint const & server,
+                           std::string const &                    response,
+                           std::string const &                    divergent_response)
+      {
+         PAXOS_ASSERT_EQ (server.port (), 1339);
+         PAXOS_ASSERT_EQ (response, "bar");
+         PAXOS_ASSERT_EQ (divergent_response, "baz");
+
+         ++divergence_count;
+      };
+
+   paxos::configuration configuration1;
+   paxos::configuration configuration2;
+   paxos::configuration configuration3;
+
+   configuration1.set_commit_on_majority (true);
+   configuration2.set_commit_on_majority (true);
+   configuration3.set_commit_on_majority (true);
+
+   configuration1.set_divergence_callback (divergence_callback);
+   configuration2.set_divergence_callback (divergence_callback);
+   configuration3.set_divergence_callback (divergence_callback);
+
+   paxos::server server1 ("127.0.0.1", 1337, callback, configuration1);
+   paxos::server server2 ("127.0.0.1", 1338, callback, configuration2);
+
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   paxos::client client;
+   client.add  ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   /*!
+     Ensure the third server lags behind when it joins, so that it does not become our leader.
+    */
+   PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+   PAXOS_ASSERT_EQ (response_count.load (), 2);
+
+   paxos::server server3 ("127.0.0.1", 1339, slow_callback, configuration3);
+   server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   boost::this_thread::sleep (
+      boost::posix_time::milliseconds (
+         paxos::configuration ().timeout ()));
+
+   /*!
+     None of these requests has to wait for the third server.
+    */
+   for (size_t i = 0; i < 5; ++i)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+   }
+
+   PAXOS_ASSERT_EQ (response_count.load (), 2 * 6);
+   PAXOS_ASSERT_EQ (divergence_count.load (), 0);
+
+   released = true;
+
+   /*!
+     Keep the quorum busy until the leader has noticed that the third server does not agree
+     with the responses the client received, and the third server has caught up with all
+     proposals it missed.
+    */
+   size_t requests = 6;
+
+   do
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+      ++requests;
+
+      for (size_t i = 0; i < 10 && response_count.load () != 3 * requests; ++i)
+      {
+         boost::this_thread::sleep (boost::posix_time::milliseconds (10));
+      }
+
+   } while (divergence_count.load () == 0
+            || response_count.load () != 3 * requests);
+
+   /*!
+     Give the leader a moment to receive the last response of the third server, which it no
+     longer waits for.
+    */
+   boost::this_thread::sleep (boost::posix_time::milliseconds (100));
+
+   PAXOS_INFO ("test succeeded");
+}
@@ -0,0 +1,72 @@
+/*!
+  Validates the multi-paxos strategy, which skips the prepare phase for consecutive proposals,
+  and whether it falls back to a full prepare round when a server leaves the quorum.
+ */
+
+#include <atomic>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/configuration.hpp>
+#include <paxos++/detail/util/debug.hpp>
+#include <paxos++/detail/strategy/multi_paxos/factory.hpp>
+
+int main ()
+{
+   std::atomic <uint16_t> response_count (0);
+
+   paxos::server::callback_type callback =
+      [& response_count](int64_t, std::string const & workload) -> std::string
+      {
+         ++response_count;
+         return workload;
+      };
+
+   paxos::configuration configuration1;
+   paxos::configuration configuration2;
+   paxos::configuration configuration3;
+
+   configuration1.set_strategy_factory (
+      new paxos::detail::strategy::multi_paxos::factory (configuration1));
+   configuration2.set_strategy_factory (
+      new paxos::detail::strategy::multi_paxos::factory (configuration2));
+   configuration3.set_strategy_factory (
+      new paxos::detail::strategy::multi_paxos::factory (configuration3));
+
+   paxos::server server1 ("127.0.0.1", 1337, callback, configuration1);
+   paxos::server server2 ("127.0.0.1", 1338, callback, configuration2);
+
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   paxos::client client;
+   client.add  ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   {
+      paxos::server server3 ("127.0.0.1", 1339, callback, configuration3);
+      server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+      for (size_t i = 0; i < 20; ++i)
+      {
+         PAXOS_ASSERT_EQ (client.send ("foo").get (), "foo");
+      }
+
+      PAXOS_ASSERT_EQ (response_count.load (), 3 * 20);
+   }
+
+   /*!
+     The quorum has changed, so the leader needs to prepare again before it can stream
+     accept-only rounds. Note that the first accept-only round that still included the dead
+     server may have been processed by the live servers before it was retried.
+    */
+   response_count = 0;
+
+   for (size_t i = 0; i < 20; ++i)
+   {
+      PAXOS_ASSERT_EQ (client.send ("bar").get (), "bar");
+   }
+
+   PAXOS_ASSERT_GE (response_count.load (), 2 * 20);
+
+   PAXOS_INFO ("test succeeded");
+}
@@ -0,0 +1,93 @@
+/*!
+  Validates that a leader can have multiple proposals in progress at the same time, while all
+  servers still process the proposals in order.
+ */
+
+#include <atomic>
+#include <vector>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/configuration.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+int main ()
+{
+   std::atomic <uint16_t> response_count (0);
+
+   /*!
+     Every server gets its own callback, which validates the proposals arrive in order.
+    */
+   auto create_callback =
+      [& response_count](int64_t & last_proposal_id) -> paxos::server::callback_type
+      {
+         return
+            [& response_count, & last_proposal_id](int64_t proposal_id, std::string const & workload) -> std::string
+            {
+               PAXOS_ASSERT_EQ (proposal_id, last_proposal_id + 1);
+               last_proposal_id = proposal_id;
+
+               ++response_count;
+               return workload;
+            };
+      };
+
+   int64_t last_proposal_id1 = 0;
+   int64_t last_proposal_id2 = 0;
+   int64_t last_proposal_id3 = 0;
+
+   paxos::configuration configuration1;
+   paxos::configuration configuration2;
+   paxos::configuration configuration3;
+
+   configuration1.set_max_inflight_proposals (8);
+   configuration2.set_max_inflight_proposals (8);
+   configuration3.set_max_inflight_proposals (8);
+
+   paxos::server server1 ("127.0.0.1", 1337, create_callback (last_proposal_id1), configuration1);
+   paxos::server server2 ("127.0.0.1", 1338, create_callback (last_proposal_id2), configuration2);
+   paxos::server server3 ("127.0.0.1", 1339, create_callback (last_proposal_id3), configuration3);
+
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   /*!
+     A single client only has one request in progress at the same time, so we need multiple
+     clients to fill the pipeline.
+    */
+   paxos::client client1;
+   paxos::client client2;
+   paxos::client client3;
+   paxos::client client4;
+
+   client1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   client2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   client3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   client4.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   std::vector <std::future <std::string> > futures1;
+   std::vector <std::future <std::string> > futures2;
+   std::vector <std::future <std::string> > futures3;
+   std::vector <std::future <std::string> > futures4;
+
+   for (size_t i = 0; i < 50; ++i)
+   {
+      futures1.push_back (client1.send ("foo"));
+      futures2.push_back (client2.send ("bar"));
+      futures3.push_back (client3.send ("baz"));
+      futures4.push_back (client4.send ("qux"));
+   }
+
+   for (size_t i = 0; i < 50; ++i)
+   {
+      PAXOS_ASSERT_EQ (futures1[i].get (), "foo");
+      PAXOS_ASSERT_EQ (futures2[i].get (), "bar");
+      PAXOS_ASSERT_EQ (futures3[i].get (), "baz");
+      PAXOS_ASSERT_EQ (futures4[i].get (), "qux");
+   }
+
+   PAXOS_ASSERT_GE (response_count.load (), 3 * 4 * 50);
+
+   PAXOS_INFO ("test succeeded");
+}
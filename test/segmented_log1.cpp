@@ -0,0 +1,113 @@
+/*!
+  Validates the segmented log storage backend: accepted values must be retrievable, old history
+  must be removed per segment, everything must still be there after the log has been reopened,
+  and a damaged record at the end of the log must be discarded.
+ */
+
+#include <stdio.h>
+#include <dirent.h>
+#include <unistd.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <paxos++/durable/segmented_log.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+static void
+remove_directory (
+   std::string const &  directory)
+{
+   DIR * handle = opendir (directory.c_str ());
+
+   if (handle == NULL)
+   {
+      return;
+   }
+
+   while (struct dirent * entry = readdir (handle))
+   {
+      unlink ((directory + "/" + entry->d_name).c_str ());
+   }
+
+   closedir (handle);
+   rmdir (directory.c_str ());
+}
+
+int main ()
+{
+   std::string const directory = "segmented_log1.history";
+
+   remove_directory (directory);
+
+   {
+      /*!
+        Every value takes up 16 bytes of header plus 4 bytes of data, so a new segment is started
+        every 10 values.
+       */
+      paxos::durable::segmented_log storage (directory, 200, false);
+      storage.set_history_size (25);
+
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 0);
+      PAXOS_ASSERT_EQ (storage.lowest_proposal_id (), 0);
+
+      for (int64_t i = 1; i <= 100; ++i)
+      {
+         storage.accept (i, boost::lexical_cast <std::string> (1000 + i), i);
+      }
+
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 100);
+
+      /*!
+        The last cleanup was issued at proposal 100, and removes all segments that only contain
+        proposals before 75.
+       */
+      PAXOS_ASSERT_EQ (storage.lowest_proposal_id (), 71);
+
+      std::map <int64_t, std::string> history = storage.retrieve (72);
+
+      PAXOS_ASSERT_EQ (history.size (), 28);
+      PAXOS_ASSERT_EQ (history.begin ()->first, 73);
+      PAXOS_ASSERT_EQ (history.begin ()->second, "1073");
+      PAXOS_ASSERT_EQ (history.rbegin ()->second, "1100");
+
+      PAXOS_ASSERT_EQ (storage.retrieve (0).size (), 30);
+      PAXOS_ASSERT_EQ (storage.retrieve (100).size (), 0);
+   }
+
+   {
+      paxos::durable::segmented_log storage (directory, 200, false);
+
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 100);
+      PAXOS_ASSERT_EQ (storage.lowest_proposal_id (), 71);
+
+      storage.accept (101, "1101", 101);
+      storage.accept (102, "1102", 102);
+
+      PAXOS_ASSERT_EQ (storage.retrieve (99).size (), 3);
+      PAXOS_ASSERT_EQ (storage.retrieve (101).begin ()->second, "1102");
+   }
+
+   {
+      /*!
+        Simulate a crash while the last value was being written.
+       */
+      FILE * file = fopen ((directory + "/00000000000000000101.log").c_str (), "r+");
+      PAXOS_ASSERT (file != NULL);
+      PAXOS_ASSERT_EQ (fseek (file, -2, SEEK_END), 0);
+      PAXOS_ASSERT_EQ (fputc ('x', file), 'x');
+      fclose (file);
+
+      paxos::durable::segmented_log storage (directory, 200, false);
+
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 101);
+      PAXOS_ASSERT_EQ (storage.retrieve (100).size (), 1);
+
+      storage.accept (102, "2102", 102);
+
+      PAXOS_ASSERT_EQ (storage.retrieve (101).begin ()->second, "2102");
+   }
+
+   remove_directory (directory);
+
+   PAXOS_INFO ("test succeeded");
+}
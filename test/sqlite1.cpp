@@ -0,0 +1,69 @@
+/*!
+  Validates the sqlite storage backend: accepted values must be retrievable, old history must
+  be removed, and everything must still be there after the database has been reopened.
+ */
+
+#include <unistd.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <paxos++/durable/sqlite.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+int main ()
+{
+   std::string const filename = "sqlite1.sqlite";
+
+   unlink (filename.c_str ());
+   unlink ((filename + "-wal").c_str ());
+   unlink ((filename + "-shm").c_str ());
+
+   {
+      paxos::durable::sqlite storage (filename,
+                                      true,
+                                      paxos::durable::sqlite::synchronous_normal);
+      storage.set_history_size (10);
+
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 0);
+      PAXOS_ASSERT_EQ (storage.lowest_proposal_id (), 0);
+
+      for (int64_t i = 1; i <= 30; ++i)
+      {
+         storage.accept (i, boost::lexical_cast <std::string> (i), i);
+      }
+
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 30);
+
+      /*!
+        A cleanup is issued at proposals 20 and 30, which removes everything before the
+        proposal history_size () ago.
+       */
+      PAXOS_ASSERT_EQ (storage.lowest_proposal_id (), 20);
+
+      std::map <int64_t, std::string> history = storage.retrieve (25);
+
+      PAXOS_ASSERT_EQ (history.size (), 5);
+      PAXOS_ASSERT_EQ (history.begin ()->first, 26);
+      PAXOS_ASSERT_EQ (history.rbegin ()->second, "30");
+   }
+
+   {
+      paxos::durable::sqlite storage (filename,
+                                      true,
+                                      paxos::durable::sqlite::synchronous_normal);
+
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 30);
+      PAXOS_ASSERT_EQ (storage.lowest_proposal_id (), 20);
+
+      storage.accept (31, "31", 31);
+
+      PAXOS_ASSERT_EQ (storage.retrieve (30).size (), 1);
+      PAXOS_ASSERT_EQ (storage.retrieve (30).begin ()->second, "31");
+   }
+
+   unlink (filename.c_str ());
+   unlink ((filename + "-wal").c_str ());
+   unlink ((filename + "-shm").c_str ());
+
+   PAXOS_INFO ("test succeeded");
+}
@@ -0,0 +1,194 @@
+/*!
+  Validates that a failed write to durable storage is reported instead of taking down the
+  server: the segmented log must be left as it was before the failed write, a follower that
+  cannot store a proposal must reply with an error, and it must catch up once its storage works
+  again.
+
+  Write failures are injected by lowering the maximum file size of the process, which makes
+  every write beyond that size fail.
+ */
+
+#include <signal.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/configuration.hpp>
+#include <paxos++/exception/exception.hpp>
+#include <paxos++/durable/segmented_log.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+static void
+remove_directory (
+   std::string const &  directory)
+{
+   DIR * handle = opendir (directory.c_str ());
+
+   if (handle == NULL)
+   {
+      return;
+   }
+
+   while (struct dirent * entry = readdir (handle))
+   {
+      unlink ((directory + "/" + entry->d_name).c_str ());
+   }
+
+   closedir (handle);
+   rmdir (directory.c_str ());
+}
+
+static off_t
+file_size (
+   std::string const &  filename)
+{
+   struct stat status;
+   PAXOS_ASSERT_EQ (stat (filename.c_str (), &status), 0);
+
+   return status.st_size;
+}
+
+/*!
+  Makes all writes beyond \c size fail with EFBIG
+ */
+static void
+limit_file_size (
+   rlim_t               size)
+{
+   struct rlimit limit;
+   PAXOS_ASSERT_EQ (getrlimit (RLIMIT_FSIZE, &limit), 0);
+
+   limit.rlim_cur = size;
+   PAXOS_ASSERT_EQ (setrlimit (RLIMIT_FSIZE, &limit), 0);
+}
+
+int main ()
+{
+   std::string const directory = "write_failure1.history";
+   std::string const segment   = directory + "/00000000000000000001.log";
+
+   /*!
+     Without this, exceeding the limit kills the process instead of failing the write.
+    */
+   signal (SIGXFSZ, SIG_IGN);
+
+   struct rlimit original_limit;
+   PAXOS_ASSERT_EQ (getrlimit (RLIMIT_FSIZE, &original_limit), 0);
+
+   remove_directory (directory);
+
+   {
+      paxos::durable::segmented_log storage (directory);
+
+      for (int64_t i = 1; i <= 10; ++i)
+      {
+         storage.accept (i, boost::lexical_cast <std::string> (1000 + i), i);
+      }
+
+      /*!
+        Only the first part of the header of the next record fits.
+       */
+      limit_file_size (file_size (segment) + 8);
+
+      PAXOS_ASSERT_THROW (storage.accept (11, "1011", 11), paxos::exception::storage_error);
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 10);
+
+      limit_file_size (original_limit.rlim_cur);
+
+      /*!
+        The same proposal can be stored again, and overwrites whatever was partially written.
+       */
+      storage.accept (11, "1011", 11);
+      storage.accept (12, "1012", 12);
+
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 12);
+      PAXOS_ASSERT_EQ (storage.retrieve (10).size (), 2);
+   }
+
+   {
+      paxos::durable::segmented_log storage (directory);
+
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 12);
+
+      std::map <int64_t, std::string> history = storage.retrieve (0);
+
+      PAXOS_ASSERT_EQ (history.size (), 12);
+      PAXOS_ASSERT_EQ (history[11], "1011");
+      PAXOS_ASSERT_EQ (history[12], "1012");
+   }
+
+   remove_directory (directory);
+
+   /*!
+     Now validate that a server whose storage fails stays alive and reports the error.
+    */
+   paxos::configuration configuration3;
+   configuration3.set_durable_storage (
+      new paxos::durable::segmented_log (directory));
+
+   paxos::server::callback_type callback =
+      [](int64_t, std::string const & workload) -> std::string
+      {
+         return workload;
+      };
+
+   paxos::server server1 ("127.0.0.1", 1337, callback);
+   paxos::server server2 ("127.0.0.1", 1338, callback);
+   paxos::server server3 ("127.0.0.1", 1339, callback, configuration3);
+   paxos::client client;
+
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   client.add  ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   for (size_t i = 0; i < 3; ++i)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "foo");
+   }
+
+   int64_t highest_proposal_id = configuration3.durable_storage ().highest_proposal_id ();
+
+   limit_file_size (file_size (segment));
+
+   /*!
+     We do not retry, so that we see the error of the follower itself; we might still have to
+     ask around for the leader, though.
+    */
+   bool storage_failed = false;
+
+   for (size_t i = 0; i < 10 && storage_failed == false; ++i)
+   {
+      try
+      {
+         client.send ("bar", 1).get ();
+      }
+      catch (paxos::exception::storage_error const &)
+      {
+         storage_failed = true;
+      }
+      catch (paxos::exception::no_leader const &)
+      {
+      }
+   }
+
+   limit_file_size (original_limit.rlim_cur);
+
+   PAXOS_ASSERT_EQ (storage_failed, true);
+   PAXOS_ASSERT_EQ (configuration3.durable_storage ().highest_proposal_id (), highest_proposal_id);
+
+   /*!
+     The follower catches up with the proposal it missed, which might take a few retries.
+    */
+   PAXOS_ASSERT_EQ (client.send ("baz").get (), "baz");
+   PAXOS_ASSERT_GE (configuration3.durable_storage ().highest_proposal_id (), highest_proposal_id + 2);
+
+   remove_directory (directory);
+
+   PAXOS_INFO ("test succeeded");
+}
@@ -0,0 +1,167 @@
+/*!
+  Validates the write queue of a connection: messages must arrive intact and in order when the
+  other side cannot keep up, the queue statistics must reflect the data that is waiting, and
+  servers and clients must expose them.
+ */
+
+#include <atomic>
+#include <future>
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/detail/command.hpp>
+#include <paxos++/detail/tcp_connection.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+static std::string
+create_workload (
+   size_t       index)
+{
+   std::string workload = boost::lexical_cast <std::string> (index);
+   workload.resize (64 * 1024, 'x');
+
+   return workload;
+}
+
+int main ()
+{
+   size_t const message_count = 1000;
+
+   {
+      boost::asio::io_service io_service;
+      boost::asio::io_service::work work (io_service);
+      boost::thread io_thread ([& io_service] () { io_service.run (); });
+
+      boost::asio::ip::tcp::endpoint endpoint (
+         boost::asio::ip::address::from_string ("127.0.0.1"), 1340);
+
+      boost::asio::ip::tcp::acceptor acceptor (io_service, endpoint);
+
+      paxos::detail::tcp_connection_ptr writer = paxos::detail::tcp_connection::create (io_service);
+      paxos::detail::tcp_connection_ptr reader = paxos::detail::tcp_connection::create (io_service);
+
+      writer->socket ().connect (endpoint);
+      acceptor.accept (reader->socket ());
+
+      /*!
+        Nobody reads from the other side yet, so most of these will still be waiting once the
+        socket buffers are full.
+       */
+      for (size_t i = 0; i < message_count; ++i)
+      {
+         paxos::detail::command command;
+         command.set_type (paxos::detail::command::type_request_initiate);
+         command.set_workload (create_workload (i));
+
+         writer->write_command (command);
+      }
+
+      boost::this_thread::sleep (boost::posix_time::milliseconds (100));
+
+      PAXOS_ASSERT_GT (writer->queued_bytes (), 1024 * 1024);
+      PAXOS_ASSERT_GE (writer->max_queued_bytes (), writer->queued_bytes ());
+
+      size_t max_queued_bytes = writer->max_queued_bytes ();
+
+      std::atomic <size_t> received (0);
+      std::promise <void> done;
+
+      for (size_t i = 0; i < message_count; ++i)
+      {
+         reader->read_command (
+            [i, & received, & done] (boost::optional <enum paxos::detail::error_code>     error,
+                                     paxos::detail::command const &                       command)
+            {
+               PAXOS_ASSERT (!error);
+               PAXOS_ASSERT (command.workload () == create_workload (i));
+
+               if (++received == message_count)
+               {
+                  done.set_value ();
+               }
+            });
+      }
+
+      done.get_future ().get ();
+
+      /*!
+        The writer is notified of the last write shortly after the reader has received it.
+       */
+      for (size_t i = 0; i < 100 && writer->queued_bytes () > 0; ++i)
+      {
+         boost::this_thread::sleep (boost::posix_time::milliseconds (10));
+      }
+
+      PAXOS_ASSERT_EQ (writer->queued_bytes (), 0);
+      PAXOS_ASSERT_EQ (writer->max_queued_bytes (), max_queued_bytes);
+
+      writer->close ();
+      reader->close ();
+      acceptor.close ();
+
+      io_service.stop ();
+      io_thread.join ();
+   }
+
+   /*!
+     Now validate that servers and clients expose the statistics of their connections.
+    */
+   paxos::server::callback_type callback =
+      [](int64_t, std::string const & workload) -> std::string
+      {
+         return workload;
+      };
+
+   paxos::server server1 ("127.0.0.1", 1337, callback);
+   paxos::server server2 ("127.0.0.1", 1338, callback);
+   paxos::server server3 ("127.0.0.1", 1339, callback);
+   paxos::client client;
+
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   client.add  ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   for (size_t i = 0; i < 10; ++i)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "foo");
+   }
+
+   /*!
+     Whoever is our leader has sent proposals to all servers, including itself.
+    */
+   size_t servers_written_to = 0;
+
+   for (paxos::server * server : { &server1, &server2, &server3 })
+   {
+      for (paxos::connection_statistics const & statistics : server->statistics ())
+      {
+         PAXOS_ASSERT_EQ (statistics.host, "127.0.0.1");
+         PAXOS_ASSERT_GE (statistics.port, 1337);
+         PAXOS_ASSERT_LE (statistics.port, 1339);
+         PAXOS_ASSERT_GE (statistics.max_queued_bytes, statistics.queued_bytes);
+
+         if (statistics.max_queued_bytes > 0)
+         {
+            ++servers_written_to;
+         }
+      }
+   }
+
+   PAXOS_ASSERT_GE (servers_written_to, 3);
+
+   size_t client_queued_bytes = 0;
+
+   for (paxos::connection_statistics const & statistics : client.statistics ())
+   {
+      client_queued_bytes += statistics.max_queued_bytes;
+   }
+
+   PAXOS_ASSERT_GT (client_queued_bytes, 0);
+
+   PAXOS_INFO ("test succeeded");
+}